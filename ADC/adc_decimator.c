@@ -0,0 +1,132 @@
+/*
+ * adc_decimator.c
+ *
+ *  Oversampling and decimation of ADC scan frames (CIC filter per channel)
+ */
+
+#include "adc_decimator.h"
+
+#if defined(__CORTEX_M)
+#define adc_stats_lock()     uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define adc_stats_unlock()   __set_PRIMASK(primask)
+#else
+// host: no interrupt preempts the main loop
+#define adc_stats_lock()
+#define adc_stats_unlock()
+#endif
+
+static void adc_decimator_clear_stats(adc_decimator *decimator)
+{
+    for (uint8_t c = 0; c < ADC_DMA_CHANNELS; c++)
+    {
+        decimator->stats[c].min = UINT16_MAX;
+        decimator->stats[c].max = 0;
+        decimator->stats[c].count = 0;
+        decimator->stats[c].sum = 0;
+    }
+}
+
+static void adc_decimator_push(adc_decimator *decimator, const adc_result *result)
+{
+    if (!adc_result_ring_push(&decimator->queue, result)) decimator->dropped++;
+}
+
+static void adc_decimator_output(adc_decimator *decimator)
+{
+    adc_result result;
+    uint16_t max_value = (1 << (ADC_RESOLUTION + decimator->shift_bits)) - 1;
+
+    // only this ISR writes stats, so the main loop request is applied here
+    if (decimator->stats_reset)
+    {
+        adc_decimator_clear_stats(decimator);
+        decimator->stats_reset = false;
+    }
+
+    for (uint8_t c = 0; c < ADC_DMA_CHANNELS; c++)
+    {
+        // unsigned: the integrators wrap and the differences undo it (modulo 2^32)
+        uint32_t value = decimator->integrator[ADC_CIC_ORDER - 1][c];
+
+        for (uint8_t k = 0; k < ADC_CIC_ORDER; k++)
+        {
+            uint32_t delayed = decimator->comb[k][c];
+            decimator->comb[k][c] = value;
+            value -= delayed;
+        }
+
+        value >>= decimator->shift;
+        if (value > max_value) value = max_value;
+        result.value[c] = value;
+
+        adc_statistics *stats = &decimator->stats[c];
+        if (value < stats->min) stats->min = value;
+        if (value > stats->max) stats->max = value;
+        stats->sum += value;
+        stats->count++;
+    }
+
+    result.index = decimator->results++;
+    adc_decimator_push(decimator, &result);
+}
+
+void adc_decimator_init(adc_decimator *decimator, uint8_t log2_ratio, uint8_t extra_bits)
+{
+    memset(decimator, 0, sizeof(adc_decimator));
+    adc_result_ring_init(&decimator->queue);
+    if (extra_bits > 4) extra_bits = 4;
+
+    decimator->log2_ratio = log2_ratio;
+    decimator->shift_bits = extra_bits;
+    // CIC gain is ratio ^ order
+    decimator->shift = (ADC_CIC_ORDER * log2_ratio > extra_bits) ? ADC_CIC_ORDER * log2_ratio - extra_bits : 0;
+    adc_decimator_clear_stats(decimator);
+}
+
+void adc_decimator_process(adc_decimator *decimator, const uint16_t *frames, uint16_t nums_of_frame)
+{
+    uint16_t ratio_mask = (1 << decimator->log2_ratio) - 1;
+
+    for (uint16_t i = 0; i < nums_of_frame; i++)
+    {
+        for (uint8_t c = 0; c < ADC_DMA_CHANNELS; c++)
+        {
+            uint32_t value = frames[c];
+            for (uint8_t k = 0; k < ADC_CIC_ORDER; k++)
+            {
+                decimator->integrator[k][c] += value;
+                value = decimator->integrator[k][c];
+            }
+        }
+        frames += ADC_DMA_CHANNELS;
+
+        decimator->phase = (decimator->phase + 1) & ratio_mask;
+        if (decimator->phase == 0) adc_decimator_output(decimator);
+    }
+}
+
+bool adc_decimator_read(adc_decimator *decimator, adc_result *result)
+{
+    return adc_result_ring_pop(&decimator->queue, result);
+}
+
+void adc_decimator_get_stats(adc_decimator *decimator, uint8_t channel, adc_statistics *stats)
+{
+    adc_stats_lock();
+    *stats = decimator->stats[channel];
+    bool reset = decimator->stats_reset;
+    adc_stats_unlock();
+
+    if (reset)
+    {
+        stats->min = UINT16_MAX;
+        stats->max = 0;
+        stats->count = 0;
+        stats->sum = 0;
+    }
+}
+
+void adc_decimator_reset_stats(adc_decimator *decimator)
+{
+    decimator->stats_reset = true;
+}
@@ -0,0 +1,107 @@
+/*
+ * adc_decimator.h
+ *
+ *  Oversampling and decimation of ADC scan frames (CIC filter per channel)
+ *  Every ADC_CIC_RATIO frames give one result per channel with extra_bits more resolution
+ *  Results go to main loop through a lock-free single producer / single consumer queue
+ *
+ *  Example:
+ *      adc_decimator_init(&decimator, 6, 2);  // 64 frames per result, 14 bits
+ *
+ *      void adc_dma_block_callback(adc_dma *adc, const uint16_t *block)
+ *      {
+ *          adc_decimator_process(&decimator, block, ADC_DMA_FRAMES);
+ *      }
+ *
+ *      // main loop
+ *      adc_result result;
+ *      while (adc_decimator_read(&decimator, &result)) { ... }
+ *
+ *      adc_statistics stats;
+ *      adc_decimator_get_stats(&decimator, 0, &stats);  // consistent copy, ISR may be running
+ */
+
+#ifndef _ADC_DECIMATOR_H_
+#define _ADC_DECIMATOR_H_
+
+#include "adc_dma.h"
+#include "../RingBuffer/spsc_ring.h"
+
+/* User Configurations */
+#define ADC_CIC_ORDER        2   // 1 = plain averaging, 2 = better alias rejection
+#define ADC_RESULT_QUEUE     8   // results kept for main loop, power of 2
+#define ADC_RESOLUTION       12  // bits of raw samples
+/* End User Configurations */
+
+typedef struct
+{
+    uint16_t value[ADC_DMA_CHANNELS];    // ADC_RESOLUTION + extra_bits bits
+    uint32_t index;                      // result number, gaps mean the queue was full
+} adc_result;
+
+typedef struct
+{
+    uint16_t min;
+    uint16_t max;
+    uint32_t count;
+    uint64_t sum;                        // mean = sum / count
+} adc_statistics;
+
+SPSC_RING_DEFINE(adc_result_ring, adc_result, ADC_RESULT_QUEUE)
+
+typedef struct
+{
+    uint32_t integrator[ADC_CIC_ORDER][ADC_DMA_CHANNELS]; // wraps modulo 2^32, the comb difference is still exact
+    uint32_t comb[ADC_CIC_ORDER][ADC_DMA_CHANNELS];       // previous integrator output
+    uint8_t log2_ratio;                  // frames per result = 1 << log2_ratio
+    uint8_t shift_bits;                  // extra resolution bits
+    uint8_t shift;                       // CIC gain removal
+    uint16_t phase;                      // frames since last result
+    uint32_t results;
+    adc_statistics stats[ADC_DMA_CHANNELS]; // written by ISR, read with adc_decimator_get_stats
+    volatile bool stats_reset;           // main loop request, ISR clears stats at next result
+
+    adc_result_ring queue;               // ISR -> main loop
+    volatile uint32_t dropped;
+} adc_decimator;
+
+/**
+  * @brief  Init decimator
+  * @param  *decimator is pointer to the decimator structure
+  * @param  log2_ratio is log2 of frames per result (output rate = frame rate >> log2_ratio)
+  *         gain ratio ^ ADC_CIC_ORDER must fit 32 bits: max 10 for order 2, 20 for order 1
+  * @param  extra_bits is resolution added by oversampling (0 - 4, at most log2_ratio / 2 is real)
+*/
+void adc_decimator_init(adc_decimator *decimator, uint8_t log2_ratio, uint8_t extra_bits);
+
+/**
+  * @brief  Feed interleaved scan frames (call from adc_dma_block_callback)
+  * @param  *decimator is pointer to the decimator structure
+  * @param  *frames is frames * ADC_DMA_CHANNELS samples
+  * @param  nums_of_frame is number of frames
+*/
+void adc_decimator_process(adc_decimator *decimator, const uint16_t *frames, uint16_t nums_of_frame);
+
+/**
+  * @brief  Take oldest result (main loop)
+  * @param  *decimator is pointer to the decimator structure
+  * @param  *result receives the result
+  * @return true if a result was available
+*/
+bool adc_decimator_read(adc_decimator *decimator, adc_result *result);
+
+/**
+  * @brief  Copy min/max/mean statistics of one channel (main loop), interrupts are masked during the copy
+  * @param  *decimator is pointer to the decimator structure
+  * @param  channel is 0 to ADC_DMA_CHANNELS - 1
+  * @param  *stats receives the statistics (empty while a reset is pending)
+*/
+void adc_decimator_get_stats(adc_decimator *decimator, uint8_t channel, adc_statistics *stats);
+
+/**
+  * @brief  Reset min/max/mean statistics, done by the ISR before the next result
+  * @param  *decimator is pointer to the decimator structure
+*/
+void adc_decimator_reset_stats(adc_decimator *decimator);
+
+#endif
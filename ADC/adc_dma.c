@@ -0,0 +1,46 @@
+/*
+ * adc_dma.c
+ *
+ *  Double buffered ADC scan over circular DMA
+ */
+
+#include "adc_dma.h"
+
+static void adc_dma_process(adc_dma *adc, uint8_t half)
+{
+    const uint16_t *block = &adc->buffer[half * ADC_DMA_HALF_SIZE];
+
+    // 12 bits samples fit in int16
+    if (adc->filter) apply_multi_filter_block(adc->filter, (const int16_t *)block, ADC_DMA_FRAMES);
+    adc_dma_block_callback(adc, block);
+    adc->blocks++;
+
+    // DMA must still be writing the other half, else it overwrote samples while they were read
+    uint32_t position = 2 * ADC_DMA_HALF_SIZE - __HAL_DMA_GET_COUNTER(adc->hadc->DMA_Handle);
+    if ((position >= ADC_DMA_HALF_SIZE) == half) adc->overruns++;
+}
+
+HAL_StatusTypeDef adc_dma_start(adc_dma *adc, ADC_HandleTypeDef *hadc, multi_filter *filter)
+{
+    adc->hadc = hadc;
+    adc->filter = filter;
+    adc->blocks = 0;
+    adc->overruns = 0;
+
+    return HAL_ADC_Start_DMA(hadc, (uint32_t *)adc->buffer, 2 * ADC_DMA_HALF_SIZE);
+}
+
+void adc_dma_stop(adc_dma *adc)
+{
+    HAL_ADC_Stop_DMA(adc->hadc);
+}
+
+void adc_dma_half_complete(adc_dma *adc)	{	adc_dma_process(adc, 0);	}
+
+void adc_dma_complete(adc_dma *adc)	{	adc_dma_process(adc, 1);	}
+
+__weak void adc_dma_block_callback(adc_dma *adc, const uint16_t *block)
+{
+    UNUSED(adc);
+    UNUSED(block);
+}
@@ -0,0 +1,72 @@
+/*
+ * adc_dma.h
+ *
+ *  Double buffered ADC scan over circular DMA
+ *  DMA fills one half of the buffer while the other half is processed as one block
+ *
+ *  Example (replaces HAL_ADC_Start_DMA(&hadc1, adc, 5)):
+ *      reset_multi_filter(&adc_filter, ADC_DMA_CHANNELS, 4);
+ *      adc_dma_start(&adc1, &hadc1, &adc_filter);
+ *
+ *      void HAL_ADC_ConvHalfCpltCallback(ADC_HandleTypeDef *hadc) { adc_dma_half_complete(&adc1); }
+ *      void HAL_ADC_ConvCpltCallback(ADC_HandleTypeDef *hadc)     { adc_dma_complete(&adc1); }
+ */
+
+#ifndef _ADC_DMA_H_
+#define _ADC_DMA_H_
+
+#include "main.h"
+#include <stdbool.h>
+#include "../AVERAGE FILTER/multi_filter.h"
+
+/* User Configurations */
+#define ADC_DMA_CHANNELS 5   // = hadc->Init.NbrOfConversion
+#define ADC_DMA_FRAMES   64  // scan frames per half buffer
+/* End User Configurations */
+
+#define ADC_DMA_HALF_SIZE (ADC_DMA_FRAMES * ADC_DMA_CHANNELS)
+
+typedef struct
+{
+    ADC_HandleTypeDef *hadc;
+    uint16_t buffer[2 * ADC_DMA_HALF_SIZE]; // DMA circular buffer (2 halves)
+    multi_filter *filter;                   // optional, NULL if not used
+    volatile uint32_t blocks;               // processed half buffers
+    volatile uint32_t overruns;             // DMA was back in a half before its processing ended
+} adc_dma;
+
+/**
+  * @brief  Start ADC scan with circular DMA into both halves of adc->buffer
+  * @param  *adc is pointer to the adc dma structure
+  * @param  *hadc is ADC handle (scan + continuous, DMA circular)
+  * @param  *filter is multi channel filter (reset with ADC_DMA_CHANNELS) updated with every block, NULL if not used
+  * @retval HAL status of HAL_ADC_Start_DMA
+*/
+HAL_StatusTypeDef adc_dma_start(adc_dma *adc, ADC_HandleTypeDef *hadc, multi_filter *filter);
+
+/**
+  * @brief  Stop ADC and DMA
+  * @param  *adc is pointer to the adc dma structure
+*/
+void adc_dma_stop(adc_dma *adc);
+
+/**
+  * @brief  First half is ready, throw into HAL_ADC_ConvHalfCpltCallback
+  * @param  *adc is pointer to the adc dma structure
+*/
+void adc_dma_half_complete(adc_dma *adc);
+
+/**
+  * @brief  Second half is ready, throw into HAL_ADC_ConvCpltCallback
+  * @param  *adc is pointer to the adc dma structure
+*/
+void adc_dma_complete(adc_dma *adc);
+
+/**
+  * @brief  Called with every finished half buffer (weak, override it in user code)
+  * @param  *adc is pointer to the adc dma structure
+  * @param  *block is ADC_DMA_FRAMES frames of ADC_DMA_CHANNELS samples (interleaved)
+*/
+void adc_dma_block_callback(adc_dma *adc, const uint16_t *block);
+
+#endif
@@ -19,9 +19,26 @@ void apply_filter(average_filter *filter, int16_t input)
     filter->buffer[filter->count] = input;
     filter->sum += filter->buffer[filter->count];
     
-    filter->count = (filter->count + 1) % AVERAGE_LENGTH;
+    if (++filter->count >= AVERAGE_LENGTH) filter->count = 0;
 
-    filter->out = (filter->sum * 1.0f) / AVERAGE_LENGTH;
+    filter->out = filter->sum * (1.0f / AVERAGE_LENGTH);
+}
+
+void apply_filter_block(average_filter *filter, const int16_t *input, uint16_t length)
+{
+    int32_t sum = filter->sum;
+    uint16_t count = filter->count;
+
+    for (uint16_t i = 0; i < length; i++)
+    {
+        sum += input[i] - filter->buffer[count];
+        filter->buffer[count] = input[i];
+        if (++count >= AVERAGE_LENGTH) count = 0;
+    }
+
+    filter->sum = sum;
+    filter->count = count;
+    filter->out = sum * (1.0f / AVERAGE_LENGTH);
 }
 
 void constrain(int32_t *value, int32_t min_value, int32_t max_value)
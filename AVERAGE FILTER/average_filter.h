@@ -2,7 +2,9 @@
 #define _AVERAGE_FILTER_H_
 
  #include "main.h"
+#ifndef AVERAGE_LENGTH
 #define AVERAGE_LENGTH 10
+#endif
 #define map(a, b, c, d, e) (((a - b)*1.0/(c - b)) * (e - d) + d)
 
 typedef struct
@@ -26,6 +28,14 @@ void reset_buffer(average_filter *filter);
 */
 void apply_filter(average_filter *filter, int16_t input);
 
+/**
+  * @brief  update average filter with a block of samples (e.g. DMA half buffer)
+  * @param  *filter is pointer to the average filter structure
+  * @param  *input is array of samples in arrival order
+  * @param  length is number of samples
+*/
+void apply_filter_block(average_filter *filter, const int16_t *input, uint16_t length);
+
 /**
   * @brief  limit value in the range
   * @param  *value is pointer to the value which you want to constrain
@@ -33,4 +43,46 @@ void apply_filter(average_filter *filter, int16_t input);
 */
 void constrain(int32_t *value, int32_t min_value, int32_t max_value);
 
+/*
+  Moving average with 2^SHIFT samples, the length is chosen per filter type
+  Wrap uses a mask and mean uses a shift, so no modulo or divide in ISR
+
+  Example:
+      AVERAGE_FILTER_DEFINE(enc_filter, 2)    // 4 samples
+      AVERAGE_FILTER_DEFINE(sonic_filter, 5)  // 32 samples
+
+      enc_filter filter;
+      enc_filter_reset(&filter);
+      int16_t mean = enc_filter_apply(&filter, input);
+*/
+#define AVERAGE_FILTER_DEFINE(name, SHIFT)                                      \
+typedef struct                                                                  \
+{                                                                               \
+    int16_t buffer[1 << (SHIFT)];                                               \
+    int32_t sum;                                                                \
+    int16_t out;                                                                \
+    uint16_t count;                                                             \
+} name;                                                                         \
+                                                                                \
+static inline void name##_reset(name *filter)                                   \
+{                                                                               \
+    filter->sum = 0;                                                            \
+    filter->out = 0;                                                            \
+    filter->count = 0;                                                          \
+    for (int i = 0; i < (1 << (SHIFT)); i++)                                    \
+    {                                                                           \
+        filter->buffer[i] = 0;                                                  \
+    }                                                                           \
+}                                                                               \
+                                                                                \
+/* mean is rounded toward minus infinity, sum keeps the full resolution */     \
+static inline int16_t name##_apply(name *filter, int16_t input)                 \
+{                                                                               \
+    filter->sum += input - filter->buffer[filter->count];                       \
+    filter->buffer[filter->count] = input;                                      \
+    filter->count = (filter->count + 1) & ((1 << (SHIFT)) - 1);                 \
+    filter->out = filter->sum >> (SHIFT);                                       \
+    return filter->out;                                                         \
+}
+
 #endif
@@ -0,0 +1,210 @@
+/*
+ * filter_bench.c
+ *
+ *  Host benchmark of cost per update of average, median and hampel filters, and of the
+ *  multi channel average (generic C path) against one average filter per channel
+ *  Window length is compile time (like on target), build once per size:
+ *
+ *    for n in 5 9 15 31 63; do
+ *      gcc -O2 -I "AVERAGE FILTER" -I Platform/sim -D MEDIAN_LENGTH=$n -D AVERAGE_LENGTH=$n \
+ *          "AVERAGE FILTER/average_filter.c" "AVERAGE FILTER/median_filter.c" \
+ *          "AVERAGE FILTER/multi_filter.c" "AVERAGE FILTER/bench/filter_bench.c" -o filter_bench && ./filter_bench
+ *    done
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "average_filter.h"
+#include "median_filter.h"
+#include "multi_filter.h"
+
+#define BENCH_SAMPLES 1000000
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define bench_cycles() __rdtsc()
+#else
+#define bench_cycles() 0ull
+#endif
+
+static int16_t samples[BENCH_SAMPLES];
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+// ultrasonic like signal: slow ramp, noise and 1% wild echoes
+static void make_samples(void)
+{
+	srand(1);
+	for (uint32_t i = 0; i < BENCH_SAMPLES; i++)
+	{
+		samples[i] = 3000 + (i % 2000) + rand() % 64;
+		if (rand() % 100 == 0) samples[i] = rand() % 30000;
+	}
+}
+
+#define BENCH(name, reset, apply, filter, sink)                                      \
+do                                                                                   \
+{                                                                                    \
+	reset(&filter);                                                                  \
+	uint64_t t0 = now_ns();                                                          \
+	uint64_t c0 = bench_cycles();                                                    \
+	for (uint32_t i = 0; i < BENCH_SAMPLES; i++)                                     \
+	{                                                                                \
+		apply(&filter, samples[i]);                                                  \
+		sink += filter.out;                                                          \
+	}                                                                                \
+	uint64_t c1 = bench_cycles();                                                    \
+	uint64_t t1 = now_ns();                                                          \
+	printf("%-8s %4u %8.2f %8.1f\n", name, (unsigned)MEDIAN_LENGTH,                 \
+		   (double)(t1 - t0) / BENCH_SAMPLES, (double)(c1 - c0) / BENCH_SAMPLES);   \
+} while (0)
+
+// other lengths than MEDIAN_LENGTH in the same program
+MEDIAN_FILTER_DEFINE(median_even, 8)
+MEDIAN_FILTER_DEFINE(median_long, 101)
+
+// brute force reference: median and MAD of the insertion sorted window
+static int check_window(median_window *window, uint16_t length)
+{
+	int16_t samples_window[255] = {0};
+
+	for (uint32_t i = 0; i < 20000; i++)
+	{
+		int16_t sorted[255];
+		uint16_t deviation[255];
+		samples_window[i % length] = samples[i];
+		int16_t median = median_window_apply(window, samples[i]);
+
+		memcpy(sorted, samples_window, length * sizeof(int16_t));
+		for (int a = 1; a < length; a++)
+			for (int b = a; b > 0 && sorted[b - 1] > sorted[b]; b--)
+			{
+				int16_t t = sorted[b]; sorted[b] = sorted[b - 1]; sorted[b - 1] = t;
+			}
+		if (median != sorted[length / 2]) return 0;
+
+		for (int a = 0; a < length; a++) deviation[a] = abs(sorted[a] - median);
+		for (int a = 1; a < length; a++)
+			for (int b = a; b > 0 && deviation[b - 1] > deviation[b]; b--)
+			{
+				uint16_t t = deviation[b]; deviation[b] = deviation[b - 1]; deviation[b - 1] = t;
+			}
+		if ((i & 15) == 0 && median_window_mad(window) != deviation[length / 2]) return 0;
+	}
+	return 1;
+}
+
+static int check_median(void)
+{
+	median_filter filter;
+	median_even even;
+	median_long longer;
+
+	median_filter_reset(&filter);
+	median_even_reset(&even);
+	median_long_reset(&longer);
+	return check_window(&filter.window, MEDIAN_LENGTH) && check_window(&even.window, 8) &&
+		   check_window(&longer.window, 101);
+}
+
+// one filter per channel with the length and rounding of multi_filter
+AVERAGE_FILTER_DEFINE(channel_filter, MULTI_FILTER_MAX_SHIFT)
+
+// multi_filter against independent channel filters, single frames and blocks of 4 frames
+// frames are interleaved channels taken straight from samples
+static int check_multi(uint8_t channels)
+{
+	multi_filter multi, block;
+	channel_filter single[MULTI_FILTER_MAX_CHANNELS];
+
+	reset_multi_filter(&multi, channels, MULTI_FILTER_MAX_SHIFT);
+	reset_multi_filter(&block, channels, MULTI_FILTER_MAX_SHIFT);
+	for (uint8_t c = 0; c < channels; c++) channel_filter_reset(&single[c]);
+
+	for (uint32_t i = 0; (i + 1) * channels <= 40000; i++)
+	{
+		const int16_t *frame = &samples[i * channels];
+		apply_multi_filter(&multi, frame);
+		if (i % 4 == 3) apply_multi_filter_block(&block, frame - 3 * channels, 4);
+
+		for (uint8_t c = 0; c < channels; c++)
+		{
+			channel_filter_apply(&single[c], frame[c]);
+			if (multi.sum[c] != single[c].sum || multi.out[c] != single[c].out) return 0;
+			if (i % 4 == 3 && (block.sum[c] != multi.sum[c] || block.out[c] != multi.out[c])) return 0;
+		}
+	}
+	return 1;
+}
+
+static void bench_multi(int64_t *sink)
+{
+	const uint8_t channels = MULTI_FILTER_MAX_CHANNELS;
+	const uint32_t frames = BENCH_SAMPLES / MULTI_FILTER_MAX_CHANNELS;
+	multi_filter multi;
+	channel_filter single[MULTI_FILTER_MAX_CHANNELS];
+
+	reset_multi_filter(&multi, channels, MULTI_FILTER_MAX_SHIFT);
+	uint64_t t0 = now_ns();
+	uint64_t c0 = bench_cycles();
+	for (uint32_t i = 0; i < frames; i++)
+	{
+		apply_multi_filter(&multi, &samples[i * channels]);
+		*sink += multi.out[i % channels];
+	}
+	uint64_t c1 = bench_cycles();
+	uint64_t t1 = now_ns();
+	printf("multi x%u  %4u %8.2f %8.1f  (per frame)\n", channels, 1u << MULTI_FILTER_MAX_SHIFT,
+		   (double)(t1 - t0) / frames, (double)(c1 - c0) / frames);
+
+	for (uint8_t c = 0; c < channels; c++) channel_filter_reset(&single[c]);
+	t0 = now_ns();
+	c0 = bench_cycles();
+	for (uint32_t i = 0; i < frames; i++)
+	{
+		for (uint8_t c = 0; c < channels; c++) channel_filter_apply(&single[c], samples[i * channels + c]);
+		*sink += single[i % channels].out;
+	}
+	c1 = bench_cycles();
+	t1 = now_ns();
+	printf("%u x avg   %4u %8.2f %8.1f  (per frame)\n", channels, 1u << MULTI_FILTER_MAX_SHIFT,
+		   (double)(t1 - t0) / frames, (double)(c1 - c0) / frames);
+}
+
+int main(void)
+{
+	average_filter average;
+	median_filter median;
+	hampel_filter hampel;
+	volatile int64_t sink = 0;
+	int64_t total = 0;
+
+	make_samples();
+	if (!check_median())
+	{
+		printf("median window mismatch\n");
+		return 1;
+	}
+	if (!check_multi(MULTI_FILTER_MAX_CHANNELS) || !check_multi(5))
+	{
+		printf("multi filter mismatch\n");
+		return 1;
+	}
+
+	printf("filter   size  ns/upd   cyc/upd\n");
+	BENCH("average", reset_buffer, apply_filter, average, total);
+	BENCH("median", reset_median_filter, apply_median_filter, median, total);
+	BENCH("hampel", reset_hampel_filter, apply_hampel_filter, hampel, total);
+	printf("hampel outliers %u / %u\n", (unsigned)hampel.outliers, BENCH_SAMPLES);
+	bench_multi(&total);
+
+	sink = total;
+	(void)sink;
+	return 0;
+}
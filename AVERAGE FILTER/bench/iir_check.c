@@ -0,0 +1,186 @@
+/*
+ * iir_check.c
+ *
+ *  Host check of the biquads against a double precision direct form I reference
+ *  Low pass and notch sections, each fed an impulse, a step and noise (half of full scale):
+ *  float32 direct form II, Q15 and Q31 direct form I. The reference uses the same
+ *  coefficients as the filter under test (float, or rounded to Q14 / Q30), so the error
+ *  is the one of the arithmetic: state rounding, accumulator width, saturation.
+ *  Fixed point output is rounded once per sample (|e| <= 0.5 LSB), the feedback 1 / A(z)
+ *  adds these up at most by its L1 norm: the limit is 0.5 LSB * L1 (plus a little for the
+ *  truncated Q31 products). Exit code is 0 when every error is inside its limit.
+ *
+ *  Build and run (from the repository root):
+ *    gcc -O2 -D PLATFORM_SIM -I "AVERAGE FILTER" -I Platform/sim "AVERAGE FILTER/iir_filter.c" \
+ *        "AVERAGE FILTER/bench/iir_check.c" Platform/sim/platform_sim.c -lm -o iir_check
+ *    ./iir_check
+ */
+
+#include <stdio.h>
+#include "iir_filter.h"
+
+#define CHECK_SAMPLES   4000
+#define LIMIT_F32       1e-5    // of full scale
+#define LIMIT_MARGIN    0.05    // LSB above the rounding bound
+
+typedef enum
+{
+	SIGNAL_IMPULSE = 0,
+	SIGNAL_STEP,
+	SIGNAL_NOISE,
+	SIGNALS
+} signal_type;
+
+static const char *signal_name[SIGNALS] = {"impulse", "step", "noise"};
+
+typedef struct
+{
+	double b0, b1, b2, a1, a2;
+	double x1, x2, y1, y2;
+} biquad_ref;
+
+static void reset_ref(biquad_ref *ref, double b0, double b1, double b2, double a1, double a2)
+{
+	*ref = (biquad_ref){b0, b1, b2, a1, a2, 0, 0, 0, 0};
+}
+
+static double apply_ref(biquad_ref *ref, double input)
+{
+	double y = ref->b0 * input + ref->b1 * ref->x1 + ref->b2 * ref->x2 - ref->a1 * ref->y1 - ref->a2 * ref->y2;
+	ref->x2 = ref->x1;
+	ref->x1 = input;
+	ref->y2 = ref->y1;
+	ref->y1 = y;
+	return y;
+}
+
+// sum of |impulse response| of 1 / (1 + a1 z^-1 + a2 z^-2), stable sections decay long before the end
+static double feedback_l1(double a1, double a2)
+{
+	double y1 = 0, y2 = 0, sum = 0;
+
+	for (uint32_t i = 0; i < 100000; i++)
+	{
+		double y = (i == 0) - a1 * y1 - a2 * y2;
+		sum += fabs(y);
+		y2 = y1;
+		y1 = y;
+	}
+	return sum;
+}
+
+// input in -0.5..0.5 of full scale, noise is the same sequence every run
+static double signal_at(signal_type type, uint32_t i, uint32_t *seed)
+{
+	switch (type)
+	{
+	case SIGNAL_IMPULSE:
+		return (i == 0) ? 0.5 : 0.0;
+	case SIGNAL_STEP:
+		return 0.5;
+	default:
+		*seed = *seed * 1664525u + 1013904223u;
+		return ((*seed >> 8) / 16777216.0 - 0.5) * 0.9;
+	}
+}
+
+// each returns max |filter - reference| in full scale units
+static double check_f32(const biquad_coeffs *c, signal_type type)
+{
+	biquad_f32 filter;
+	biquad_ref ref;
+	uint32_t seed = 1;
+	double error = 0;
+
+	reset_biquad_f32(&filter, c);
+	reset_ref(&ref, c->b0, c->b1, c->b2, c->a1, c->a2);
+	for (uint32_t i = 0; i < CHECK_SAMPLES; i++)
+	{
+		float x = (float)signal_at(type, i, &seed);
+		apply_biquad_f32(&filter, x);
+		double e = fabs(filter.out - apply_ref(&ref, x));
+		if (e > error) error = e;
+	}
+	return error;
+}
+
+static double check_q15(const biquad_coeffs *c, signal_type type)
+{
+	biquad_q15 filter;
+	biquad_ref ref;
+	uint32_t seed = 1;
+	double error = 0;
+
+	reset_biquad_q15(&filter, c);
+	reset_ref(&ref, filter.b0 / 16384.0, filter.b1 / 16384.0, filter.b2 / 16384.0,
+			  filter.a1 / 16384.0, filter.a2 / 16384.0);
+	for (uint32_t i = 0; i < CHECK_SAMPLES; i++)
+	{
+		int16_t x = (int16_t)lround(signal_at(type, i, &seed) * 32768.0);
+		apply_biquad_q15(&filter, x);
+		double e = fabs(filter.out / 32768.0 - apply_ref(&ref, x / 32768.0));
+		if (e > error) error = e;
+	}
+	return error;
+}
+
+static double check_q31(const biquad_coeffs *c, signal_type type)
+{
+	biquad_q31 filter;
+	biquad_ref ref;
+	uint32_t seed = 1;
+	double error = 0;
+	const double q30 = 1073741824.0, q31 = 2147483648.0;
+
+	reset_biquad_q31(&filter, c);
+	reset_ref(&ref, filter.b0 / q30, filter.b1 / q30, filter.b2 / q30, filter.a1 / q30, filter.a2 / q30);
+	for (uint32_t i = 0; i < CHECK_SAMPLES; i++)
+	{
+		int32_t x = (int32_t)llround(signal_at(type, i, &seed) * q31);
+		apply_biquad_q31(&filter, x);
+		double e = fabs(filter.out / q31 - apply_ref(&ref, x / q31));
+		if (e > error) error = e;
+	}
+	return error;
+}
+
+static int check_section(const char *name, const biquad_coeffs *c)
+{
+	biquad_q15 q15_section;
+	biquad_q31 q31_section;
+	int failed = 0;
+
+	reset_biquad_q15(&q15_section, c);
+	reset_biquad_q31(&q31_section, c);
+	double limit_q15 = 0.5 * feedback_l1(q15_section.a1 / 16384.0, q15_section.a2 / 16384.0) + LIMIT_MARGIN;
+	double limit_q31 = 0.5 * feedback_l1(q31_section.a1 / 1073741824.0, q31_section.a2 / 1073741824.0) + LIMIT_MARGIN;
+	printf("%-8s limit    %10.2e %8.2f %8.2f\n", name, LIMIT_F32, limit_q15, limit_q31);
+
+	for (signal_type type = 0; type < SIGNALS; type++)
+	{
+		double f32 = check_f32(c, type);
+		double q15 = check_q15(c, type) * 32768.0;
+		double q31 = check_q31(c, type) * 2147483648.0;
+		int ok = f32 <= LIMIT_F32 && q15 <= limit_q15 && q31 <= limit_q31;
+
+		printf("%-8s %-8s %10.2e %8.2f %8.2f  %s\n", name, signal_name[type], f32, q15, q31, ok ? "ok" : "FAIL");
+		if (!ok) failed++;
+	}
+	return failed;
+}
+
+int main(void)
+{
+	biquad_coeffs lowpass, notch;
+	int failed = 0;
+
+	biquad_lowpass(&lowpass, 50.0f, 1000.0f, 0.7071f);
+	biquad_notch(&notch, 50.0f, 1000.0f, 5.0f);
+
+	printf("section  signal   f32 (FS)  q15 lsb  q31 lsb\n");
+	failed += check_section("lowpass", &lowpass);
+	failed += check_section("notch", &notch);
+
+	printf("%s: %d cases over the limit\n", failed ? "FAIL" : "PASS", failed);
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+#include "iir_filter.h"
+
+static int16_t saturate_q15(int32_t value)
+{
+    if (value > INT16_MAX) return INT16_MAX;
+    if (value < INT16_MIN) return INT16_MIN;
+    return value;
+}
+
+static int32_t saturate_q31(int64_t value)
+{
+    if (value > INT32_MAX) return INT32_MAX;
+    if (value < INT32_MIN) return INT32_MIN;
+    return value;
+}
+
+static int16_t float_to_q14(float value)
+{
+    return saturate_q15(lroundf(value * 16384.0f));
+}
+
+static int32_t float_to_q30(float value)
+{
+    return saturate_q31(llroundf(value * 1073741824.0f));
+}
+
+float ema_alpha(float cutoff_hz, float sample_hz)
+{
+    return 1.0f - expf(-2.0f * M_PI * cutoff_hz / sample_hz);
+}
+
+void reset_ema_f32(ema_filter_f32 *filter, float alpha)
+{
+    filter->alpha = alpha;
+    filter->out = 0.0f;
+}
+
+void reset_ema_q15(ema_filter_q15 *filter, float alpha)
+{
+    filter->alpha = FLOAT_TO_Q15(alpha);
+    filter->state = 0;
+    filter->out = 0;
+}
+
+void reset_ema_q31(ema_filter_q31 *filter, float alpha)
+{
+    filter->alpha = FLOAT_TO_Q31(alpha);
+    filter->out = 0;
+}
+
+void apply_ema_f32(ema_filter_f32 *filter, float input)
+{
+    filter->out += filter->alpha * (input - filter->out);
+}
+
+void apply_ema_q15(ema_filter_q15 *filter, int16_t input)
+{
+    // full scale swing is 2^32 in Q15 << 16, only fits in 64 bits
+    int64_t diff = (int64_t)input * 65536 - filter->state;
+    filter->state += (filter->alpha * diff) >> 15;
+    filter->out = filter->state >> 16;
+}
+
+void apply_ema_q31(ema_filter_q31 *filter, int32_t input)
+{
+    // |diff| <= 2^32 - 1 and alpha <= 2^31 - 1 (FLOAT_TO_Q31 saturates): product stays below 2^63
+    int64_t diff = (int64_t)input - filter->out;
+    filter->out += (diff * (int64_t)filter->alpha) >> 31;
+}
+
+void biquad_lowpass(biquad_coeffs *coeffs, float cutoff_hz, float sample_hz, float q)
+{
+    float w0 = 2.0f * M_PI * cutoff_hz / sample_hz;
+    float alpha = sinf(w0) / (2.0f * q);
+    float cos_w0 = cosf(w0);
+    float a0 = 1.0f + alpha;
+
+    coeffs->b0 = (1.0f - cos_w0) / 2.0f / a0;
+    coeffs->b1 = (1.0f - cos_w0) / a0;
+    coeffs->b2 = coeffs->b0;
+    coeffs->a1 = -2.0f * cos_w0 / a0;
+    coeffs->a2 = (1.0f - alpha) / a0;
+}
+
+void biquad_notch(biquad_coeffs *coeffs, float center_hz, float sample_hz, float q)
+{
+    float w0 = 2.0f * M_PI * center_hz / sample_hz;
+    float alpha = sinf(w0) / (2.0f * q);
+    float cos_w0 = cosf(w0);
+    float a0 = 1.0f + alpha;
+
+    coeffs->b0 = 1.0f / a0;
+    coeffs->b1 = -2.0f * cos_w0 / a0;
+    coeffs->b2 = coeffs->b0;
+    coeffs->a1 = coeffs->b1;
+    coeffs->a2 = (1.0f - alpha) / a0;
+}
+
+void reset_biquad_f32(biquad_f32 *filter, const biquad_coeffs *coeffs)
+{
+    filter->coeffs = *coeffs;
+    filter->w1 = 0.0f;
+    filter->w2 = 0.0f;
+    filter->out = 0.0f;
+}
+
+void reset_biquad_q15(biquad_q15 *filter, const biquad_coeffs *coeffs)
+{
+    filter->b0 = float_to_q14(coeffs->b0);
+    filter->b1 = float_to_q14(coeffs->b1);
+    filter->b2 = float_to_q14(coeffs->b2);
+    filter->a1 = float_to_q14(coeffs->a1);
+    filter->a2 = float_to_q14(coeffs->a2);
+    filter->x1 = filter->x2 = filter->y1 = filter->y2 = 0;
+    filter->out = 0;
+}
+
+void reset_biquad_q31(biquad_q31 *filter, const biquad_coeffs *coeffs)
+{
+    filter->b0 = float_to_q30(coeffs->b0);
+    filter->b1 = float_to_q30(coeffs->b1);
+    filter->b2 = float_to_q30(coeffs->b2);
+    filter->a1 = float_to_q30(coeffs->a1);
+    filter->a2 = float_to_q30(coeffs->a2);
+    filter->x1 = filter->x2 = filter->y1 = filter->y2 = 0;
+    filter->out = 0;
+}
+
+void apply_biquad_f32(biquad_f32 *filter, float input)
+{
+    const biquad_coeffs *c = &filter->coeffs;
+    float w = input - c->a1 * filter->w1 - c->a2 * filter->w2;
+
+    filter->out = c->b0 * w + c->b1 * filter->w1 + c->b2 * filter->w2;
+    filter->w2 = filter->w1;
+    filter->w1 = w;
+}
+
+// fixed point keeps input/output history (direct form I): the direct form II
+// delay line grows by 1 / (1 + a1 + a2) at low cutoff and would overflow
+void apply_biquad_q15(biquad_q15 *filter, int16_t input)
+{
+    // |a1|, |b1| reach 2.0 (notch): the sum of 5 products needs more than 32 bits
+    int64_t acc = (int64_t)filter->b0 * input
+                + (int64_t)filter->b1 * filter->x1
+                + (int64_t)filter->b2 * filter->x2
+                - (int64_t)filter->a1 * filter->y1
+                - (int64_t)filter->a2 * filter->y2; // Q29
+
+    int16_t y = saturate_q15((acc + (1 << 13)) >> 14);
+
+    filter->x2 = filter->x1;
+    filter->x1 = input;
+    filter->y2 = filter->y1;
+    filter->y1 = y;
+    filter->out = y;
+}
+
+void apply_biquad_q31(biquad_q31 *filter, int32_t input)
+{
+    // Q30 * Q31 = Q61, >> 2 keeps 5 terms inside int64
+    int64_t acc = (((int64_t)filter->b0 * input) >> 2)
+                + (((int64_t)filter->b1 * filter->x1) >> 2)
+                + (((int64_t)filter->b2 * filter->x2) >> 2)
+                - (((int64_t)filter->a1 * filter->y1) >> 2)
+                - (((int64_t)filter->a2 * filter->y2) >> 2); // Q59
+
+    // rounded as the Q15 section: truncation is a bias the poles amplify (1 / (1 + a1 + a2) at DC)
+    int32_t y = saturate_q31((acc + (1 << 27)) >> 28);
+
+    filter->x2 = filter->x1;
+    filter->x1 = input;
+    filter->y2 = filter->y1;
+    filter->y1 = y;
+    filter->out = y;
+}
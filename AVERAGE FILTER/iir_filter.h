@@ -0,0 +1,122 @@
+#ifndef _IIR_FILTER_H_
+#define _IIR_FILTER_H_
+
+#include "main.h"
+#include <math.h>
+
+/*
+  Single pole EMA and biquad (low pass / notch) filters
+  Each comes in float32, Q15 and Q31
+  Coefficients come from cutoff and sample rate: call the design functions once
+  (at init, or on host and keep the printed numbers as const)
+*/
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// float coefficient to fixed point (constant expression, usable in const initializers)
+#define FLOAT_TO_Q15(x) ((int16_t)((x) >= 0.999969f ? 32767 : (x) * 32768.0f + ((x) >= 0 ? 0.5f : -0.5f)))
+#define FLOAT_TO_Q31(x) ((int32_t)((x) >= 0.9999999995 ? 2147483647 : (x) * 2147483648.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+/* EMA: out += alpha * (input - out) */
+typedef struct
+{
+    float alpha;
+    float out;
+} ema_filter_f32;
+
+typedef struct
+{
+    int16_t alpha;  // Q15
+    int32_t state;  // Q15 << 16, extra bits avoid dead band at small alpha
+    int16_t out;    // Q15
+} ema_filter_q15;
+
+typedef struct
+{
+    int32_t alpha;  // Q31
+    int32_t out;    // Q31
+} ema_filter_q31;
+
+/* Biquad: y = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2) x */
+typedef struct
+{
+    float b0, b1, b2;
+    float a1, a2;
+} biquad_coeffs;
+
+typedef struct
+{
+    biquad_coeffs coeffs;
+    float w1, w2;   // direct form II delay line
+    float out;
+} biquad_f32;
+
+typedef struct
+{
+    int16_t b0, b1, b2, a1, a2; // Q14, coefficients can reach +-2
+    int16_t x1, x2, y1, y2;     // Q15
+    int16_t out;                // Q15
+} biquad_q15;
+
+typedef struct
+{
+    int32_t b0, b1, b2, a1, a2; // Q30
+    int32_t x1, x2, y1, y2;     // Q31
+    int32_t out;                // Q31
+} biquad_q31;
+
+/**
+  * @brief  EMA coefficient for a cutoff frequency
+  * @param  cutoff_hz is -3dB frequency
+  * @param  sample_hz is sampling rate
+  * @return alpha (0 - 1)
+*/
+float ema_alpha(float cutoff_hz, float sample_hz);
+
+void reset_ema_f32(ema_filter_f32 *filter, float alpha);
+void reset_ema_q15(ema_filter_q15 *filter, float alpha);
+void reset_ema_q31(ema_filter_q31 *filter, float alpha);
+
+/**
+  * @brief  update EMA, filtered value is in filter->out
+  * @param  *filter is pointer to the EMA structure
+  * @param  input which you want to noise filtering
+*/
+void apply_ema_f32(ema_filter_f32 *filter, float input);
+void apply_ema_q15(ema_filter_q15 *filter, int16_t input);
+void apply_ema_q31(ema_filter_q31 *filter, int32_t input);
+
+/**
+  * @brief  design 2nd order Butterworth like low pass (RBJ cookbook)
+  * @param  *coeffs receives coefficients
+  * @param  cutoff_hz is cutoff frequency
+  * @param  sample_hz is sampling rate
+  * @param  q is quality factor (0.7071 for Butterworth)
+*/
+void biquad_lowpass(biquad_coeffs *coeffs, float cutoff_hz, float sample_hz, float q);
+
+/**
+  * @brief  design notch (RBJ cookbook), e.g. motor noise
+  * @param  *coeffs receives coefficients
+  * @param  center_hz is notch frequency
+  * @param  sample_hz is sampling rate
+  * @param  q is quality factor (higher is narrower)
+*/
+void biquad_notch(biquad_coeffs *coeffs, float center_hz, float sample_hz, float q);
+
+void reset_biquad_f32(biquad_f32 *filter, const biquad_coeffs *coeffs);
+void reset_biquad_q15(biquad_q15 *filter, const biquad_coeffs *coeffs);
+void reset_biquad_q31(biquad_q31 *filter, const biquad_coeffs *coeffs);
+
+/**
+  * @brief  update biquad, filtered value is in filter->out
+  * @param  *filter is pointer to the biquad structure
+  * @param  input which you want to noise filtering
+*/
+void apply_biquad_f32(biquad_f32 *filter, float input);
+void apply_biquad_q15(biquad_q15 *filter, int16_t input);
+void apply_biquad_q31(biquad_q31 *filter, int32_t input);
+
+#endif
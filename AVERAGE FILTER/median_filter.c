@@ -0,0 +1,179 @@
+#include "median_filter.h"
+
+#define NODE_VALUE(window, node) ((window)->buffer[(window)->heap[node]])
+
+static void swap_nodes(median_window *window, uint16_t a, uint16_t b)
+{
+    uint8_t slot = window->heap[a];
+    window->heap[a] = window->heap[b];
+    window->heap[b] = slot;
+    window->position[window->heap[a]] = a;
+    window->position[window->heap[b]] = b;
+}
+
+// node a must be above node b: larger in the lower (max) heap, smaller in the upper (min) heap
+static bool above(median_window *window, uint16_t a, uint16_t b, bool lower)
+{
+    return lower ? NODE_VALUE(window, a) > NODE_VALUE(window, b)
+                 : NODE_VALUE(window, a) < NODE_VALUE(window, b);
+}
+
+// each heap starts at node base: lower heap at 0, upper heap at low
+// returns the node where the sifted sample ends up
+static uint16_t sift_up(median_window *window, uint16_t base, uint16_t node, bool lower)
+{
+    while (node > base)
+    {
+        uint16_t parent = base + (node - base - 1) / 2;
+        if (!above(window, node, parent, lower)) break;
+        swap_nodes(window, node, parent);
+        node = parent;
+    }
+    return node;
+}
+
+static void sift_down(median_window *window, uint16_t base, uint16_t size, uint16_t node, bool lower)
+{
+    for (;;)
+    {
+        uint16_t child = 2 * (node - base) + 1;
+        if (child >= size) break;
+        child += base;
+        if (child + 1 < base + size && above(window, child + 1, child, lower)) child++;
+        if (!above(window, child, node, lower)) break;
+        swap_nodes(window, node, child);
+        node = child;
+    }
+}
+
+void median_window_init(median_window *window, int16_t *buffer, uint16_t *scratch,
+                        uint8_t *heap, uint8_t *position, uint16_t length)
+{
+    window->buffer = buffer;
+    window->scratch = scratch;
+    window->heap = heap;
+    window->position = position;
+    window->length = length;
+    window->low = length / 2 + 1;
+    window->count = 0;
+
+    // all zero: any order is a valid heap
+    for (uint16_t i = 0; i < length; i++)
+    {
+        buffer[i] = 0;
+        heap[i] = i;
+        position[i] = i;
+    }
+    return;
+}
+
+int16_t median_window_apply(median_window *window, int16_t input)
+{
+    uint16_t low = window->low;
+    uint16_t high = window->length - low;
+    uint16_t node = window->position[window->count];
+
+    window->buffer[window->count] = input;
+    if (++window->count >= window->length) window->count = 0;
+
+    // restore the heap that holds the replaced slot
+    if (node < low)
+    {
+        node = sift_up(window, 0, node, true);
+        sift_down(window, 0, low, node, true);
+    }
+    else
+    {
+        node = sift_up(window, low, node, false);
+        sift_down(window, low, high, node, false);
+    }
+
+    // only one sample changed, so one exchange of the tops restores lower <= upper
+    if (high > 0 && NODE_VALUE(window, 0) > NODE_VALUE(window, low))
+    {
+        swap_nodes(window, 0, low);
+        sift_down(window, 0, low, 0, true);
+        sift_down(window, low, high, low, false);
+    }
+
+    return NODE_VALUE(window, 0);
+}
+
+// k-th smallest of array (Wirth's selection), array is reordered
+static uint16_t select_kth(uint16_t *array, uint16_t length, uint16_t k)
+{
+    int32_t left = 0;
+    int32_t right = length - 1;
+
+    while (left < right)
+    {
+        uint16_t pivot = array[k];
+        int32_t i = left;
+        int32_t j = right;
+        do
+        {
+            while (array[i] < pivot) i++;
+            while (pivot < array[j]) j--;
+            if (i <= j)
+            {
+                uint16_t temp = array[i];
+                array[i] = array[j];
+                array[j] = temp;
+                i++;
+                j--;
+            }
+        } while (i <= j);
+        if (j < k) left = i;
+        if (k < i) right = j;
+    }
+    return array[k];
+}
+
+int16_t median_window_mad(median_window *window)
+{
+    int16_t median = NODE_VALUE(window, 0);
+
+    // |x - median| of int16 always fits in uint16
+    for (uint16_t i = 0; i < window->length; i++)
+    {
+        int32_t deviation = window->buffer[i] - median;
+        window->scratch[i] = (deviation < 0) ? -deviation : deviation;
+    }
+    uint16_t mad = select_kth(window->scratch, window->length, window->length / 2);
+    return (mad > INT16_MAX) ? INT16_MAX : mad;
+}
+
+int16_t hampel_window_check(median_window *window, int16_t input, int16_t median, uint32_t *outliers)
+{
+    int32_t deviation = input - median;
+    if (deviation < 0) deviation = -deviation;
+
+    if (deviation > HAMPEL_N_SIGMA * 1.4826f * median_window_mad(window))
+    {
+        (*outliers)++;
+        return median;
+    }
+    return input;
+}
+
+void reset_median_filter(median_filter *filter)
+{
+    median_filter_reset(filter);
+    return;
+}
+
+void apply_median_filter(median_filter *filter, int16_t input)
+{
+    median_filter_apply(filter, input);
+}
+
+void reset_hampel_filter(hampel_filter *filter)
+{
+    hampel_filter_reset(filter);
+    return;
+}
+
+void apply_hampel_filter(hampel_filter *filter, int16_t input)
+{
+    hampel_filter_apply(filter, input);
+}
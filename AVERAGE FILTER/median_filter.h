@@ -0,0 +1,164 @@
+#ifndef _MEDIAN_FILTER_H_
+#define _MEDIAN_FILTER_H_
+
+#include "main.h"
+#include <string.h>
+
+/*
+  Outlier rejecting filters, same usage as average_filter
+  Window is split in two indexed heaps: a max heap with the lower LENGTH / 2 + 1 samples
+  and a min heap with the rest, so the median is the top of the lower heap
+  Each sample slot knows its heap node, the oldest sample is replaced in place and
+  sifted, at most one swap of the tops rebalances the heaps: O(log N) per update
+  No allocation, safe to call from ISR (one filter per ISR)
+*/
+
+#ifndef MEDIAN_LENGTH
+#define MEDIAN_LENGTH 5 // window of median_filter / hampel_filter, odd number of samples
+#endif
+#define HAMPEL_N_SIGMA 3.0f // outlier when |x - median| > n * 1.4826 * MAD
+
+/*
+  Window shared by every median filter type, arrays are inside the defined type
+  LENGTH up to 255 (heap indexes are uint8_t)
+*/
+typedef struct
+{
+    int16_t *buffer;    // samples in arrival order
+    uint16_t *scratch;  // deviations, only used by median_window_mad
+    uint8_t *heap;      // sample slot of each heap node, [0, low) lower heap, [low, length) upper heap
+    uint8_t *position;  // heap node of each sample slot
+    uint16_t length;
+    uint16_t low;       // size of the lower heap
+    uint16_t count;
+} median_window;
+
+/**
+  * @brief  Reset window, all samples are 0
+  * @param  *window is pointer to the window
+  * @param  *buffer, *scratch, *heap, *position are arrays of length samples
+  * @param  length is number of samples (1 to 255)
+*/
+void median_window_init(median_window *window, int16_t *buffer, uint16_t *scratch,
+                        uint8_t *heap, uint8_t *position, uint16_t length);
+
+/**
+  * @brief  replace oldest sample of the window
+  * @param  *window is pointer to the window
+  * @param  input is the new sample
+  * @retval median of the window (upper one for even length)
+*/
+int16_t median_window_apply(median_window *window, int16_t input);
+
+/**
+  * @brief  Median absolute deviation of the window, O(N) (selection on the deviations)
+  * @param  *window is pointer to the window
+*/
+int16_t median_window_mad(median_window *window);
+
+/**
+  * @brief  test newest sample against the window (after median_window_apply)
+  * @param  *window is pointer to the window
+  * @param  input is the newest sample
+  * @param  median is the median returned by median_window_apply
+  * @param  *outliers is incremented when input is an outlier
+  * @retval input, or median when input is an outlier
+*/
+int16_t hampel_window_check(median_window *window, int16_t input, int16_t median, uint32_t *outliers);
+
+/*
+  Median and hampel filters of LENGTH samples, the length is chosen per filter type
+
+  Example:
+      MEDIAN_FILTER_DEFINE(sonic_median, 7)
+      HAMPEL_FILTER_DEFINE(baro_hampel, 15)
+
+      sonic_median filter;
+      sonic_median_reset(&filter);
+      int16_t median = sonic_median_apply(&filter, input);
+*/
+#define MEDIAN_FILTER_DEFINE(name, LENGTH)                                      \
+_Static_assert((LENGTH) > 0 && (LENGTH) <= 255, #name ": LENGTH 1 to 255");     \
+typedef struct                                                                  \
+{                                                                               \
+    median_window window;                                                       \
+    int16_t buffer[LENGTH];                                                     \
+    uint16_t scratch[LENGTH];                                                   \
+    uint8_t heap[LENGTH];                                                       \
+    uint8_t position[LENGTH];                                                   \
+    int16_t out;                                                                \
+} name;                                                                         \
+                                                                                \
+static inline void name##_reset(name *filter)                                   \
+{                                                                               \
+    median_window_init(&filter->window, filter->buffer, filter->scratch,        \
+                       filter->heap, filter->position, LENGTH);                 \
+    filter->out = 0;                                                            \
+}                                                                               \
+                                                                                \
+static inline int16_t name##_apply(name *filter, int16_t input)                 \
+{                                                                               \
+    filter->out = median_window_apply(&filter->window, input);                  \
+    return filter->out;                                                         \
+}                                                                               \
+                                                                                \
+static inline int16_t name##_mad(name *filter)                                  \
+{                                                                               \
+    return median_window_mad(&filter->window);                                  \
+}
+
+#define HAMPEL_FILTER_DEFINE(name, LENGTH)                                      \
+MEDIAN_FILTER_DEFINE(name##_median, LENGTH)                                     \
+typedef struct                                                                  \
+{                                                                               \
+    name##_median window;                                                       \
+    int16_t out;                                                                \
+    uint32_t outliers;                                                          \
+} name;                                                                         \
+                                                                                \
+static inline void name##_reset(name *filter)                                   \
+{                                                                               \
+    name##_median_reset(&filter->window);                                       \
+    filter->out = 0;                                                            \
+    filter->outliers = 0;                                                       \
+}                                                                               \
+                                                                                \
+static inline int16_t name##_apply(name *filter, int16_t input)                 \
+{                                                                               \
+    int16_t median = name##_median_apply(&filter->window, input);               \
+    filter->out = hampel_window_check(&filter->window.window, input, median,    \
+                                      &filter->outliers);                       \
+    return filter->out;                                                         \
+}
+
+// default filters (median_filter_mad() comes with the type)
+MEDIAN_FILTER_DEFINE(median_filter, MEDIAN_LENGTH)
+HAMPEL_FILTER_DEFINE(hampel_filter, MEDIAN_LENGTH)
+
+/**
+  * @brief  Reset all paramater in median filter structure
+  * @param  *filter is pointer to the median filter structure
+*/
+void reset_median_filter(median_filter *filter);
+
+/**
+  * @brief  update median filter, median of last MEDIAN_LENGTH samples is in filter->out
+  * @param  *filter is pointer to the median filter structure
+  * @param  input which you want to noise filtering
+*/
+void apply_median_filter(median_filter *filter, int16_t input);
+
+/**
+  * @brief  Reset all paramater in hampel filter structure
+  * @param  *filter is pointer to the hampel filter structure
+*/
+void reset_hampel_filter(hampel_filter *filter);
+
+/**
+  * @brief  update hampel filter, filter->out is input or median when input is an outlier
+  * @param  *filter is pointer to the hampel filter structure
+  * @param  input which you want to noise filtering
+*/
+void apply_hampel_filter(hampel_filter *filter, int16_t input);
+
+#endif
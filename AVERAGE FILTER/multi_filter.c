@@ -0,0 +1,63 @@
+#include "multi_filter.h"
+
+void reset_multi_filter(multi_filter *filter, uint8_t channels, uint8_t shift)
+{
+    memset(filter, 0, sizeof(multi_filter));
+    filter->channels = (channels > MULTI_FILTER_MAX_CHANNELS) ? MULTI_FILTER_MAX_CHANNELS : channels;
+    filter->shift = (shift > MULTI_FILTER_MAX_SHIFT) ? MULTI_FILTER_MAX_SHIFT : shift;
+    return;
+}
+
+static inline void update_multi_filter(multi_filter *filter, const int16_t *input)
+{
+    int16_t *oldest = filter->buffer[filter->count];
+    uint8_t c = 0;
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+    // two channels per step: packed difference, then sign extend each half into its sum
+    for (; c + 1 < filter->channels; c += 2)
+    {
+        uint32_t new_pair;
+        uint32_t old_pair;
+        memcpy(&new_pair, &input[c], 4);
+        memcpy(&old_pair, &oldest[c], 4);
+
+        uint32_t diff = __SSUB16(new_pair, old_pair);
+        filter->sum[c]     = __SMLAD(diff, 0x00000001, filter->sum[c]);     // + low half
+        filter->sum[c + 1] = __SMLAD(diff, 0x00010000, filter->sum[c + 1]); // + high half
+
+        memcpy(&oldest[c], &new_pair, 4);
+    }
+#endif
+    for (; c < filter->channels; c++)
+    {
+        filter->sum[c] += input[c] - oldest[c];
+        oldest[c] = input[c];
+    }
+
+    filter->count = (filter->count + 1) & ((1 << filter->shift) - 1);
+}
+
+static inline void output_multi_filter(multi_filter *filter)
+{
+    for (uint8_t c = 0; c < filter->channels; c++)
+    {
+        filter->out[c] = filter->sum[c] >> filter->shift;
+    }
+}
+
+void apply_multi_filter(multi_filter *filter, const int16_t *input)
+{
+    update_multi_filter(filter, input);
+    output_multi_filter(filter);
+}
+
+void apply_multi_filter_block(multi_filter *filter, const int16_t *input, uint16_t frames)
+{
+    for (uint16_t i = 0; i < frames; i++)
+    {
+        update_multi_filter(filter, input);
+        input += filter->channels;
+    }
+    output_multi_filter(filter);
+}
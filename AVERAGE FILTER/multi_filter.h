@@ -0,0 +1,51 @@
+#ifndef _MULTI_FILTER_H_
+#define _MULTI_FILTER_H_
+
+#include "main.h"
+#include <string.h>
+
+/*
+  Moving average over many channels sampled together (e.g. ADC scan DMA buffer)
+  Storage is structure of arrays: one row of all channels per sample
+  On Cortex-M4 two channels are updated per instruction (__SSUB16, __SMLAD),
+  other targets use the scalar loop
+  Each input must stay in -16384..16383 or 0..32767 (12 bits ADC is fine)
+*/
+
+#define MULTI_FILTER_MAX_CHANNELS 8  // must be even
+#define MULTI_FILTER_MAX_SHIFT 4     // max 16 samples
+
+typedef struct
+{
+    int16_t buffer[1 << MULTI_FILTER_MAX_SHIFT][MULTI_FILTER_MAX_CHANNELS] __attribute__((aligned(4)));
+    int32_t sum[MULTI_FILTER_MAX_CHANNELS];
+    int16_t out[MULTI_FILTER_MAX_CHANNELS];
+    uint8_t channels;
+    uint8_t shift;
+    uint16_t count;
+} multi_filter;
+
+/**
+  * @brief  Reset multi channel filter
+  * @param  *filter is pointer to the multi channel filter structure
+  * @param  channels is number of channels (1 - MULTI_FILTER_MAX_CHANNELS)
+  * @param  shift is log2 of average length (0 - MULTI_FILTER_MAX_SHIFT)
+*/
+void reset_multi_filter(multi_filter *filter, uint8_t channels, uint8_t shift);
+
+/**
+  * @brief  update all channels with one sample each, means are in filter->out
+  * @param  *filter is pointer to the multi channel filter structure
+  * @param  *input is one sample per channel
+*/
+void apply_multi_filter(multi_filter *filter, const int16_t *input);
+
+/**
+  * @brief  update all channels with a block of interleaved frames (e.g. ADC scan DMA half buffer)
+  * @param  *filter is pointer to the multi channel filter structure
+  * @param  *input is frames * channels samples, one frame (all channels) after another
+  * @param  frames is number of frames
+*/
+void apply_multi_filter_block(multi_filter *filter, const int16_t *input, uint16_t frames);
+
+#endif
@@ -0,0 +1,105 @@
+/*
+ * bench.c
+ *
+ *  Timing, result table and JSON output of the benchmark suite
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "platform_sim.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define bench_cycles() __rdtsc()
+#else
+#define bench_cycles() 0ull
+#endif
+
+typedef struct
+{
+    const char *kind;
+    const char *name;
+    uint32_t samples;
+    uint64_t ns;
+    uint64_t cycles;
+    double checksum;
+} bench_result;
+
+static bench_result results[BENCH_MAX_RESULTS];
+static uint8_t nums_of_result;
+
+// every I2C driver is configured on hi2c1
+platform_i2c hi2c1;
+
+bench_clock bench_now(void)
+{
+    struct timespec ts;
+    bench_clock now;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    now.cycles = bench_cycles();
+    now.ns = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+    return now;
+}
+
+void bench_record(const char *kind, const char *name, uint32_t samples, bench_clock start, double checksum)
+{
+    bench_clock end = bench_now();
+
+    if (nums_of_result == BENCH_MAX_RESULTS) return;
+    results[nums_of_result++] = (bench_result) {kind, name, samples, end.ns - start.ns, end.cycles - start.cycles, checksum};
+}
+
+void bench_json(FILE *out, const char *label)
+{
+    fprintf(out, "{\n  \"label\": \"%s\",\n  \"compiler\": \"%s\",\n  \"results\": [\n", label ? label : "", __VERSION__);
+    for (uint8_t i = 0; i < nums_of_result; i++)
+    {
+        const bench_result *r = &results[i];
+        fprintf(out, "    {\"kind\": \"%s\", \"name\": \"%s\", \"samples\": %u, "
+                     "\"ns_per_sample\": %.2f, \"cycles_per_sample\": %.1f, \"checksum\": %.6g}%s\n",
+                r->kind, r->name, (unsigned)r->samples,
+                (double)r->ns / r->samples, (double)r->cycles / r->samples, r->checksum,
+                (i + 1 < nums_of_result) ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+void bench_make_log(bench_log *log, uint8_t columns, uint32_t rows)
+{
+    log->columns = columns;
+    log->rows = rows;
+    log->data = calloc((size_t)rows * columns, sizeof(int32_t));
+}
+
+bool bench_load_log(bench_log *log, const char *path, uint8_t columns)
+{
+    FILE *file = fopen(path, "r");
+    char line[256];
+
+    if (file == NULL) return false;
+    bench_make_log(log, columns, BENCH_LOG_ROWS);
+    log->rows = 0;
+    while (log->rows < BENCH_LOG_ROWS && fgets(line, sizeof(line), file))
+    {
+        char *p = line;
+        uint8_t c;
+
+        if (line[0] == '#') continue;
+        for (c = 0; c < columns; c++)
+        {
+            char *end;
+            while (*p == ' ' || *p == ',' || *p == '\t') p++;
+            long value = strtol(p, &end, 10);
+            if (end == p) break;
+            log->data[log->rows * columns + c] = (int32_t)value;
+            p = end;
+        }
+        if (c == columns) log->rows++;
+    }
+    fclose(file);
+    return true;
+}
@@ -0,0 +1,76 @@
+/*
+ * bench.h
+ *
+ *  Host benchmark suite of the drivers (runs on the Linux platform backend)
+ *  micro: one function in a loop, macro: a sensor log replayed through a full update pipeline
+ *  Results are printed as JSON so cost per sample can be compared between commits.
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* User Configurations */
+#define BENCH_MAX_RESULTS   32
+#define BENCH_MICRO_SAMPLES 1000000
+#define BENCH_LOG_ROWS      20000   // rows of a synthetic log, max rows of a loaded one
+/* End User Configurations */
+
+typedef struct
+{
+    uint64_t ns;
+    uint64_t cycles;                // 0 where the host has no cycle counter
+} bench_clock;
+
+typedef struct
+{
+    int32_t *data;                  // rows * columns, row major
+    uint8_t columns;
+    uint32_t rows;                  // 0 = suite makes a synthetic log
+} bench_log;
+
+/**
+  * @brief  Wall clock and cycle counter now
+*/
+bench_clock bench_now(void);
+
+/**
+  * @brief  Store one result, cost is measured from start to now
+  * @param  kind is "micro" or "macro"
+  * @param  samples is number of updates done since start
+  * @param  checksum sums the outputs, a change means the behavior changed too
+*/
+void bench_record(const char *kind, const char *name, uint32_t samples, bench_clock start, double checksum);
+
+/**
+  * @brief  Print every stored result as one JSON document
+  * @param  label is e.g. the commit id, may be NULL
+*/
+void bench_json(FILE *out, const char *label);
+
+/**
+  * @brief  Read a recorded log: one row per line, columns separated by spaces or commas, # comments
+  * @return false if the file can not be read
+*/
+bool bench_load_log(bench_log *log, const char *path, uint8_t columns);
+
+/**
+  * @brief  Allocate an empty log for a suite to fill (when nothing was loaded)
+*/
+void bench_make_log(bench_log *log, uint8_t columns, uint32_t rows);
+
+static inline int32_t bench_log_at(const bench_log *log, uint32_t row, uint8_t column)
+{
+    return log->data[row * log->columns + column];
+}
+
+/* Suites */
+void bench_motor(const bench_log *encoder_log);     // columns: encoder pulses per TIME_SAMPLING, target RPM
+void bench_imu(const bench_log *imu_log);           // columns: gyro x y z, accel x y z (raw)
+void bench_baro(void);
+void bench_sonic(const bench_log *echo_log);        // columns: echo width in us
+
+#endif
@@ -0,0 +1,47 @@
+/*
+ * bench_baro.c
+ *
+ *  BMP280 temperature / pressure compensation (datasheet example trimming values)
+ */
+
+#include "bench.h"
+#include "../GY-BMP280/gy_bmp280.h"
+
+static platform_sim_i2c_device bmp_model = { .address = I2C_BMP280_ADDRESS << 1 };
+
+static void bmp_model_trim(uint8_t reg, int32_t value)
+{
+    bmp_model.reg[reg] = (uint8_t)value;
+    bmp_model.reg[reg + 1] = (uint8_t)(value >> 8);
+}
+
+static void bmp_model_adc(uint8_t reg, int32_t adc)
+{
+    bmp_model.reg[reg] = (uint8_t)(adc >> 12);
+    bmp_model.reg[reg + 1] = (uint8_t)(adc >> 4);
+    bmp_model.reg[reg + 2] = (uint8_t)(adc << 4);
+}
+
+void bench_baro(void)
+{
+    static const int32_t trim[12] = {27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000};
+    BMP280 bmp;
+    BMP280_setup setup;
+    double checksum = 0;
+
+    for (uint8_t i = 0; i < 12; i++) bmp_model_trim(0x88 + 2 * i, trim[i]);
+    bmp_model.reg[ID] = BMP280_CHIP_ID;
+    platform_sim_i2c_attach(&hi2c1, &bmp_model);
+    bmp280_setup_Standard(&setup);
+    bmp280_init(&bmp, &setup);
+
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES / 10; i++)
+    {
+        bmp_model_adc(TEMP_MSB, 519888 + (int32_t)(i % 256));
+        bmp_model_adc(PRESS_MSB, 415148 + (int32_t)(i % 1024));
+        checksum += bmp280_get_temp(&bmp);
+        checksum += bmp280_get_altitude(&bmp);
+    }
+    bench_record("micro", "bmp280_compensation", BENCH_MICRO_SAMPLES / 10, start, checksum);
+}
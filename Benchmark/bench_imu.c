@@ -0,0 +1,113 @@
+/*
+ * bench_imu.c
+ *
+ *  MPU6050 benchmarks: Kalman filter, angle (trig) path, log replay through mpu6050_update_all
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "bench.h"
+#include "../MPU6050/mpu6050.h"
+
+#define IMU_PASS_SAMPLES 200000
+
+static platform_sim_i2c_device mpu_model = { .address = MPU6050_ADDR };
+
+static void mpu_model_set(const int32_t *raw)
+{
+    for (uint8_t i = 0; i < 3; i++)
+    {
+        mpu_model.reg[GYRO_XOUT_H + 2 * i]      = (uint8_t)(raw[i] >> 8);
+        mpu_model.reg[GYRO_XOUT_H + 2 * i + 1]  = (uint8_t)raw[i];
+        mpu_model.reg[ACCEL_XOUT_H + 2 * i]     = (uint8_t)(raw[3 + i] >> 8);
+        mpu_model.reg[ACCEL_XOUT_H + 2 * i + 1] = (uint8_t)raw[3 + i];
+    }
+}
+
+// slow roll / pitch swing with gyro rates matching it, +-8g and +-500 dps scale
+static void make_imu_log(bench_log *log)
+{
+    bench_make_log(log, 6, BENCH_LOG_ROWS);
+    srand(3);
+    for (uint32_t i = 0; i < log->rows; i++)
+    {
+        double t = i * SAMPLING_TIME;
+        double roll = 0.5 * sin(t), pitch = 0.3 * sin(0.7 * t);
+        int32_t *row = &log->data[6 * i];
+
+        row[0] = (int32_t)(0.5 * cos(t) * RAD_TO_DEG * PHYSICAL_CONVERT_GYRO) + rand() % 9 - 4;
+        row[1] = (int32_t)(0.21 * cos(0.7 * t) * RAD_TO_DEG * PHYSICAL_CONVERT_GYRO) + rand() % 9 - 4;
+        row[2] = rand() % 9 - 4;
+        row[3] = (int32_t)(-sin(pitch) * PHYSICAL_CONVERT_ACCEL) + rand() % 17 - 8;
+        row[4] = (int32_t)(sin(roll) * cos(pitch) * PHYSICAL_CONVERT_ACCEL) + rand() % 17 - 8;
+        row[5] = (int32_t)(cos(roll) * cos(pitch) * PHYSICAL_CONVERT_ACCEL) + rand() % 17 - 8;
+    }
+}
+
+static void bench_kalman(void)
+{
+    Kalman_t kalman = {0, 0};
+    double checksum = 0;
+
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        checksum += Kalman_getAngle(&kalman, (double)((int32_t)(i % 90) - 45), (double)((int32_t)(i % 30) - 15));
+        checksum += kalman.estimate_error;
+    }
+    bench_record("micro", "Kalman_getAngle", BENCH_MICRO_SAMPLES, start, checksum);
+}
+
+// full update: I2C reads on the register model, conversions, atan / sqrt / pow, Kalman
+static void bench_angles(MPU_6050 *mpu)
+{
+    static const int32_t level[6] = {65, -40, 12, 80, -120, 4096};
+    double checksum = 0;
+
+    mpu_model_set(level);
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES / 10; i++)
+    {
+        mpu6050_update_all(mpu);
+        checksum += mpu->angleRoll + mpu->anglePitch + mpu->Ax + mpu->Ay;
+    }
+    bench_record("micro", "mpu6050_update_all", BENCH_MICRO_SAMPLES / 10, start, checksum);
+}
+
+static void bench_imu_replay(MPU_6050 *mpu, const bench_log *log)
+{
+    uint32_t passes = log->rows ? (IMU_PASS_SAMPLES + log->rows - 1) / log->rows : 0;
+    double checksum = 0;
+
+    bench_clock start = bench_now();
+    for (uint32_t pass = 0; pass < passes; pass++)
+    {
+        for (uint32_t i = 0; i < log->rows; i++)
+        {
+            mpu_model_set(&log->data[6 * i]);
+            mpu6050_update_all(mpu);
+            checksum += mpu->angleRoll + mpu->anglePitch + mpu->Ax + mpu->Ay;
+        }
+    }
+    bench_record("macro", "imu_log_replay", passes * log->rows, start, checksum);
+}
+
+void bench_imu(const bench_log *imu_log)
+{
+    static const int32_t still[6] = {0, 0, 0, 0, 0, 4096};
+    bench_log log = *imu_log;
+    MPU_6050 mpu = {0};
+
+    if (log.rows == 0) make_imu_log(&log);
+
+    mpu_model.reg[WHO_AM_I] = 0x68;
+    mpu_model_set(still);
+    platform_sim_i2c_attach(&hi2c1, &mpu_model);
+    mpu6050_init(&mpu);
+    // mpu6050_init leaves the reference at 0, which skips the accel / angle path
+    mpu.ref_point_X = 1e-3;
+
+    bench_kalman();
+    bench_angles(&mpu);
+    bench_imu_replay(&mpu, &log);
+}
@@ -0,0 +1,70 @@
+/*
+ * bench_main.c
+ *
+ *  Host benchmark suite of the drivers, prints JSON on stdout
+ *
+ *  Build and run (from the repository root), with CMake (target driver_bench):
+ *    cmake -S . -B build && cmake --build build --target driver_bench
+ *    ./build/driver_bench --label $(git rev-parse --short HEAD) > bench_$(git rev-parse --short HEAD).json
+ *  or directly:
+ *    gcc -O2 -D PLATFORM_SIM -I Platform/sim Benchmark/bench*.c Platform/sim/platform_sim.c \
+ *        "AVERAGE FILTER/average_filter.c" PID/PID.c PID/pid_fixed.c PID/pid_bank.c PID/pid_cascade.c \
+ *        "PWM control/PWMcontrol.c" Encoder/Encoder.c MPU6050/mpu6050.c GY-BMP280/gy_bmp280.c UltraSonic/ultraSonic.c -lm -o driver_bench
+ *    ./driver_bench --label $(git rev-parse --short HEAD) > bench_$(git rev-parse --short HEAD).json
+ *
+ *  Recorded logs replace the synthetic ones of the macro benchmarks:
+ *    --encoder file   pulses per TIME_SAMPLING, target RPM
+ *    --imu file       gyro x y z, accel x y z (raw MPU6050 counts)
+ *    --sonic file     echo width in us
+ *
+ *  With -D PROFILER_ENABLE=1 (and Profiler/profiler.c, as the CMake target does) the per call
+ *  histograms of the profiler probes are printed on stderr
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "bench.h"
+#include "platform_sim.h"
+#include "../Profiler/profiler.h"
+
+static void write_stderr(const char *text, uint16_t len)
+{
+    fwrite(text, 1, len, stderr);
+}
+
+int main(int argc, char **argv)
+{
+    const char *label = NULL;
+    bench_log encoder_log = {0}, imu_log = {0}, echo_log = {0};
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        bool loaded = true;
+
+        if (strcmp(argv[i], "--label") == 0)        label = argv[i + 1];
+        else if (strcmp(argv[i], "--encoder") == 0) loaded = bench_load_log(&encoder_log, argv[i + 1], 2);
+        else if (strcmp(argv[i], "--imu") == 0)     loaded = bench_load_log(&imu_log, argv[i + 1], 6);
+        else if (strcmp(argv[i], "--sonic") == 0)   loaded = bench_load_log(&echo_log, argv[i + 1], 1);
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+        if (!loaded)
+        {
+            fprintf(stderr, "can not read %s\n", argv[i + 1]);
+            return 1;
+        }
+    }
+
+    platform_sim_init();
+    profiler_init();
+    bench_motor(&encoder_log);
+    bench_imu(&imu_log);
+    bench_baro();
+    bench_sonic(&echo_log);
+
+    bench_json(stdout, label);
+    profiler_dump(write_stderr);
+    return 0;
+}
@@ -0,0 +1,290 @@
+/*
+ * bench_motor.c
+ *
+ *  Moving average, PID and encoder benchmarks, encoder -> PID -> PWM pipeline
+ */
+
+#include <stdlib.h>
+#include "bench.h"
+#include "../Encoder/encoder.h"
+#include "../PID/pid_fixed.h"
+#include "../PID/pid_bank.h"
+#include "../PID/pid_cascade.h"
+#include "../Profiler/profiler.h"
+
+#define MOTOR_PASS_SAMPLES 200000   // macro benchmark replays the log up to this many updates
+
+static platform_timer htim_encoder;
+static platform_timer htim_motor;
+
+PROFILE_PROBE(probe_updateEncoder);
+PROFILE_PROBE(probe_output_PID);
+
+// motor with first order response to target steps, pulses per TIME_SAMPLING
+static void make_encoder_log(bench_log *log)
+{
+    static const int32_t targets[] = {60, 120, -90, 0, 180, -150};
+    double rpm = 0;
+
+    bench_make_log(log, 2, BENCH_LOG_ROWS);
+    srand(2);
+    for (uint32_t i = 0; i < log->rows; i++)
+    {
+        int32_t target = targets[(i / 200) % 6];
+        rpm += (target - rpm) * 0.1;
+        log->data[2 * i] = (int32_t)(rpm * PULSE_PER_REVOLUTION * TIME_SAMPLING / 60000) + rand() % 3 - 1;
+        log->data[2 * i + 1] = target;
+    }
+}
+
+static void bench_filter(void)
+{
+    average_filter filter;
+    double checksum = 0;
+
+    reset_buffer(&filter);
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        apply_filter(&filter, (int16_t)(3000 + (i % 2000) + (i * 7919) % 64));
+        checksum += filter.out;
+    }
+    bench_record("micro", "apply_filter", BENCH_MICRO_SAMPLES, start, checksum);
+}
+
+static void bench_pid(void)
+{
+    PID_instance pid;
+    double checksum = 0;
+
+    reset_PID_gain(&pid);
+    set_PID_gain(&pid, 2.0f, 0.5f, 0.01f);
+    pid.integral_error = 0;
+    pid.output_PID = 0;
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        output_PID(&pid, (int16_t)((i % 400) - 200), 1000 / TIME_SAMPLING);
+        checksum += pid.output_PID;
+    }
+    bench_record("micro", "output_PID", BENCH_MICRO_SAMPLES, start, checksum);
+
+    checksum = 0;
+    reset_PID_gain(&pid);
+    set_PID_gain(&pid, 2.0f, 0.5f, 0.01f);
+    set_PID_weight(&pid, 0.8f, 0.0f);
+    set_PID_filter(&pid, 3.0f, 1000 / TIME_SAMPLING);
+    pid.integral_error = 0;
+    pid.output_PID = 0;
+    start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        output_PID_2dof(&pid, (int16_t)((i / 400) % 2 * 200), (int16_t)((i % 400) - 200), 0, 1000 / TIME_SAMPLING);
+        checksum += pid.output_PID;
+    }
+    bench_record("micro", "output_PID_2dof", BENCH_MICRO_SAMPLES, start, checksum);
+}
+
+static void bench_pid_fixed(void)
+{
+    pid_q15 pid15;
+    pid_q31 pid31;
+    double checksum = 0;
+
+    reset_pid_q15(&pid15, 2.0f, 10.0f, 0.0005f, TIME_SAMPLING / 1000.0f, -MAX_PID_VALUE, MAX_PID_VALUE);
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        checksum += output_pid_q15(&pid15, (int16_t)((i % 400) - 200));
+    }
+    bench_record("micro", "output_pid_q15", BENCH_MICRO_SAMPLES, start, checksum);
+
+    checksum = 0;
+    reset_pid_q31(&pid31, 2.0f, 10.0f, 0.0005f, TIME_SAMPLING / 1000.0f, -MAX_PID_VALUE * 65536, MAX_PID_VALUE * 65536);
+    start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        checksum += output_pid_q31(&pid31, ((int32_t)(i % 400) - 200) * 65536) / 65536.0;
+    }
+    bench_record("micro", "output_pid_q31", BENCH_MICRO_SAMPLES, start, checksum);
+}
+
+// four wheels: one controller per axis against one bank call, checksums must match
+static void bench_pid_bank(void)
+{
+    pid_q15 wheel[4];
+    pid_bank_q15 bank;
+    pid_bank_f32 bank_f32;
+    int16_t error[4];
+    float error_f32[4];
+    double checksum = 0;
+
+    reset_pid_bank_q15(&bank, 4);
+    reset_pid_bank_f32(&bank_f32, 4);
+    for (uint8_t a = 0; a < 4; a++)
+    {
+        reset_pid_q15(&wheel[a], 2.0f, 10.0f, 0.0005f, TIME_SAMPLING / 1000.0f, -MAX_PID_VALUE, MAX_PID_VALUE);
+        set_pid_bank_q15(&bank, a, 2.0f, 10.0f, 0.0005f, TIME_SAMPLING / 1000.0f, -MAX_PID_VALUE, MAX_PID_VALUE);
+        set_pid_bank_f32(&bank_f32, a, 2.0f, 10.0f, 0.0005f, TIME_SAMPLING / 1000.0f, -MAX_PID_VALUE, MAX_PID_VALUE);
+    }
+
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES / 4; i++)
+    {
+        for (uint8_t a = 0; a < 4; a++)
+        {
+            checksum += output_pid_q15(&wheel[a], (int16_t)(((i + 100 * a) % 400) - 200));
+        }
+    }
+    bench_record("micro", "output_pid_q15_x4", BENCH_MICRO_SAMPLES, start, checksum);
+
+    checksum = 0;
+    start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES / 4; i++)
+    {
+        for (uint8_t a = 0; a < 4; a++)
+        {
+            error[a] = (int16_t)(((i + 100 * a) % 400) - 200);
+        }
+        output_pid_bank_q15(&bank, error);
+        checksum += bank.out[0] + bank.out[1] + bank.out[2] + bank.out[3];
+    }
+    bench_record("micro", "output_pid_bank_q15", BENCH_MICRO_SAMPLES, start, checksum);
+
+    checksum = 0;
+    start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES / 4; i++)
+    {
+        for (uint8_t a = 0; a < 4; a++)
+        {
+            error_f32[a] = (float)((int32_t)((i + 100 * a) % 400) - 200);
+        }
+        output_pid_bank_f32(&bank_f32, error_f32);
+        checksum += bank_f32.out[0] + bank_f32.out[1] + bank_f32.out[2] + bank_f32.out[3];
+    }
+    bench_record("micro", "output_pid_bank_f32", BENCH_MICRO_SAMPLES, start, checksum);
+}
+
+// position / velocity / current at 100 / 1k / 10k of a 10kHz tick, cost per tick
+static void bench_pid_cascade(void)
+{
+    pid_cascade axis;
+    int32_t measurement[PID_CASCADE_STAGES] = {0};
+    double checksum = 0;
+
+    reset_pid_cascade(&axis, 1.0f / 10000);
+    set_pid_cascade_stage(&axis, PID_CASCADE_POSITION, 100, 20.0f, 0.0f, 0.0f, -20000, 20000);
+    set_pid_cascade_stage(&axis, PID_CASCADE_VELOCITY, 10, 0.05f, 2.0f, 0.0f, -3000, 3000);
+    set_pid_cascade_stage(&axis, PID_CASCADE_CURRENT, 1, 0.2f, 300.0f, 0.0f, -MAX_PID_VALUE, MAX_PID_VALUE);
+    set_pid_cascade_target(&axis, 5000);
+
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        measurement[PID_CASCADE_POSITION] = (int32_t)(i % 10000);
+        measurement[PID_CASCADE_VELOCITY] = (int32_t)(i % 4000) - 2000;
+        measurement[PID_CASCADE_CURRENT] = (int32_t)(i % 2000) - 1000;
+        checksum += pid_cascade_update(&axis, measurement);
+    }
+    bench_record("micro", "pid_cascade_update", BENCH_MICRO_SAMPLES, start, checksum);
+}
+
+static void bench_diff_pulse(void)
+{
+    Encoder enc;
+    double checksum = 0;
+
+    Encoder_Init(&enc, &htim_encoder);
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        int32_t pulses = (int32_t)(i % 512) - 256;
+        int32_t diff;
+        platform_sim_encoder_move(&htim_encoder, pulses);
+        updateDiffPulse(&enc, &diff);
+        enc.pre_counter = htim_encoder.counter;
+        checksum += diff;
+    }
+    bench_record("micro", "updateDiffPulse", BENCH_MICRO_SAMPLES, start, checksum);
+
+    checksum = 0;
+    start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES; i++)
+    {
+        platform_sim_encoder_move(&htim_encoder, (int32_t)(i % 512) - 256);
+        updateEncoder(&enc, false);
+        checksum += enc._mRPM / 1000.0 + enc._PWM;
+    }
+    bench_record("micro", "updateEncoder", BENCH_MICRO_SAMPLES, start, checksum);
+}
+
+static void bench_speed_loop(const bench_log *log)
+{
+    Encoder enc;
+    PWMcontrol motor;
+    PID_instance pid;
+    uint32_t passes = log->rows ? (MOTOR_PASS_SAMPLES + log->rows - 1) / log->rows : 0;
+    double checksum = 0;
+
+    Encoder_Init(&enc, &htim_encoder);
+    Motor_Init(&motor, &htim_motor, TIM_CHANNEL_1, TIM_CHANNEL_2);
+    reset_PID_gain(&pid);
+    set_PID_gain(&pid, 2.0f, 0.5f, 0.01f);
+    pid.integral_error = 0;
+    pid.output_PID = 0;
+
+    bench_clock start = bench_now();
+    for (uint32_t pass = 0; pass < passes; pass++)
+    {
+        for (uint32_t i = 0; i < log->rows; i++)
+        {
+            platform_sim_encoder_move(&htim_encoder, bench_log_at(log, i, 0));
+            updateEncoder(&enc, false);
+            output_PID(&pid, (int16_t)(bench_log_at(log, i, 1) - enc._RPM), 1000 / TIME_SAMPLING);
+            set_motor(&motor, pid.output_PID >= 0 ? FORWARD : BACKWARD, abs(pid.output_PID));
+            checksum += pid.output_PID;
+        }
+    }
+    bench_record("macro", "encoder_pid_pwm", passes * log->rows, start, checksum);
+}
+
+// per call distribution of the speed loop stages, a separate pass so the timings above keep their cost
+static void bench_speed_probes(const bench_log *log)
+{
+    Encoder enc;
+    PID_instance pid;
+
+    Encoder_Init(&enc, &htim_encoder);
+    reset_PID_gain(&pid);
+    set_PID_gain(&pid, 2.0f, 0.5f, 0.01f);
+    pid.integral_error = 0;
+    pid.output_PID = 0;
+
+    for (uint32_t i = 0; i < log->rows; i++)
+    {
+        platform_sim_encoder_move(&htim_encoder, bench_log_at(log, i, 0));
+
+        PROFILE_BEGIN(encoder_start);
+        updateEncoder(&enc, false);
+        PROFILE_END(probe_updateEncoder, encoder_start);
+
+        PROFILE_BEGIN(pid_start);
+        output_PID(&pid, (int16_t)(bench_log_at(log, i, 1) - enc._RPM), 1000 / TIME_SAMPLING);
+        PROFILE_END(probe_output_PID, pid_start);
+    }
+}
+
+void bench_motor(const bench_log *encoder_log)
+{
+    bench_log log = *encoder_log;
+
+    if (log.rows == 0) make_encoder_log(&log);
+    bench_filter();
+    bench_pid();
+    bench_pid_fixed();
+    bench_pid_bank();
+    bench_pid_cascade();
+    bench_diff_pulse();
+    bench_speed_loop(&log);
+    bench_speed_probes(&log);
+}
@@ -0,0 +1,69 @@
+/*
+ * bench_sonic.c
+ *
+ *  Ultrasonic benchmarks: trigger pulse, echo log replay through capture callbacks
+ */
+
+#include <stdlib.h>
+#include "bench.h"
+#include "../UltraSonic/UltraSonic.h"
+
+#define SONIC_PASS_SAMPLES 200000
+
+static platform_timer htim_echo;
+
+// target moving 10 - 200 cm and back, 2% lost / wild echoes
+static void make_echo_log(bench_log *log)
+{
+    bench_make_log(log, 1, BENCH_LOG_ROWS);
+    srand(4);
+    for (uint32_t i = 0; i < log->rows; i++)
+    {
+        uint32_t cm = 10 + abs((int32_t)(i % 380) - 190);
+        log->data[i] = (int32_t)(cm * 2 / (SOUND_SPEED * STEP_TIMER)) + rand() % 20 - 10;
+        if (rand() % 50 == 0) log->data[i] = rand() % 30000;
+    }
+}
+
+static void bench_trigger(ultraSonic *sensor)
+{
+    bench_clock start = bench_now();
+    for (uint32_t i = 0; i < BENCH_MICRO_SAMPLES / 100; i++)
+    {
+        activeTrigger(sensor);
+    }
+    bench_record("micro", "activeTrigger", BENCH_MICRO_SAMPLES / 100, start, platform_sim_time_ns() / 1e9);
+}
+
+static void bench_echo_replay(ultraSonic *sensor, const bench_log *log)
+{
+    uint32_t passes = log->rows ? (SONIC_PASS_SAMPLES + log->rows - 1) / log->rows : 0;
+    double checksum = 0;
+
+    bench_clock start = bench_now();
+    for (uint32_t pass = 0; pass < passes; pass++)
+    {
+        for (uint32_t i = 0; i < log->rows; i++)
+        {
+            platform_timer_start_capture_it(&htim_echo, TIM_CHANNEL_1);
+            if (platform_sim_capture(&htim_echo, TIM_CHANNEL_1, true)) updateDistance(sensor, TIM_CHANNEL_1);
+            platform_sim_advance_ns((uint64_t)bench_log_at(log, i, 0) * 1000);
+            if (platform_sim_capture(&htim_echo, TIM_CHANNEL_1, false)) updateDistance(sensor, TIM_CHANNEL_1);
+            checksum += sensor->distance;
+        }
+    }
+    bench_record("macro", "echo_log_replay", passes * log->rows, start, checksum);
+}
+
+void bench_sonic(const bench_log *echo_log)
+{
+    static average_filter filter;
+    ultraSonic sensor;
+    bench_log log = *echo_log;
+
+    if (log.rows == 0) make_echo_log(&log);
+    ultraSonic_Init(&sensor, &htim_echo, &filter, GPIOA, GPIO_PIN_0);
+
+    bench_trigger(&sensor);
+    bench_echo_replay(&sensor, &log);
+}
@@ -1,19 +1,19 @@
 #include "encoder.h"
 
-void TimerInitENC(TIM_HandleTypeDef *h_time, uint32_t Channel)
+void TimerInitENC(platform_timer *h_time, uint32_t Channel)
 {
     // Enable Output Compare Mode
-    HAL_TIM_OC_Start_IT(h_time, Channel);
+    platform_timer_start_compare_it(h_time, Channel);
 }
 
 void updateDiffPulse(Encoder *enc, int32_t *diffPulse)
 {
-    uint16_t cur_counter = enc->htim->Instance->CNT;
+    uint16_t cur_counter = platform_timer_get_counter(enc->htim);
     if (cur_counter > enc->pre_counter)
     {
-        if (__HAL_TIM_IS_TIM_COUNTING_DOWN(enc->htim))
+        if (platform_timer_counting_down(enc->htim))
         {
-            *diffPulse = -((enc->pre_counter - cur_counter + MAX_COUNTER) % MAX_COUNTER);
+            *diffPulse = -((enc->pre_counter - cur_counter + MAX_COUNTER + 1) % (MAX_COUNTER + 1));
         }
         else
         {
@@ -22,13 +22,13 @@ void updateDiffPulse(Encoder *enc, int32_t *diffPulse)
     }
     else
     {
-        if (__HAL_TIM_IS_TIM_COUNTING_DOWN(enc->htim))
+        if (platform_timer_counting_down(enc->htim))
         {
             *diffPulse = -(enc->pre_counter - cur_counter);
         }
         else
         {
-            *diffPulse = (cur_counter - enc->pre_counter + MAX_COUNTER) % MAX_COUNTER;
+            *diffPulse = (cur_counter - enc->pre_counter + MAX_COUNTER + 1) % (MAX_COUNTER + 1);
         }
     }
     return;
@@ -40,30 +40,53 @@ void updateDiffPulse(Encoder *enc, int32_t *diffPulse)
  * and we need to divide the pulses counter by two, because
  * they include the pulses for both the channels
  */
-void updateEncoder(Encoder *enc, bool mode4X)
+static void updateSpeed(Encoder *enc, bool mode4X, int32_t mRPM)
 {
-    int32_t diffPulse = 0;
-    updateDiffPulse(enc, &diffPulse);
-    enc->_RPM = (((diffPulse * 1.0) / PULSE_PER_REVOLUTION) * 60 * 1000) / TIME_SAMPLING;
-
     // if ((TIM3->SMCR & 0x3) == 0x3 && (TIM4->SMCR & 0x3) == 0x3)
     if (mode4X)
     {
-        enc->_RPM /= 2;
+        mRPM /= 2;
     }
-    enc->_PWM = map(enc->_RPM, 0, MAX_RPM, 0, MAX_PID_VALUE);
-    enc->pre_counter = enc->htim->Instance->CNT;
-    if (enc->_RPM < 0) enc->Direction = BACKWARD;
-    else if (enc->_RPM > 0) enc->Direction = FORWARD;
+    // 32 bits stores: a read from another context is never torn
+    enc->_mRPM = mRPM;
+    enc->_RPM = (mRPM + (mRPM >= 0 ? 500 : -500)) / 1000;  // rounded, truncation biases errors toward 0
+    enc->_PWM = (int32_t)(((int64_t)mRPM * ENCODER_PWM_PER_MRPM_Q24) >> 24);
+    enc->pre_counter = platform_timer_get_counter(enc->htim);
+    if (mRPM < 0) enc->Direction = BACKWARD;
+    else if (mRPM > 0) enc->Direction = FORWARD;
     else enc->Direction = STOP;
 }
 
-void Encoder_Init(Encoder *p1, TIM_HandleTypeDef *h_time)
+void updateEncoder(Encoder *enc, bool mode4X)
+{
+    int32_t diffPulse = 0;
+    updateDiffPulse(enc, &diffPulse);
+    // one 32 x 32 -> 64 multiply (SMULL), rounded
+    updateSpeed(enc, mode4X, (int32_t)(((int64_t)diffPulse * ENCODER_MRPM_PER_PULSE_Q16 + (1 << 15)) >> 16));
+}
+
+void updateEncoder_dt(Encoder *enc, bool mode4X, uint32_t now_us)
+{
+    uint32_t dt_us = now_us - enc->pre_time_us;  // wraps correctly
+    if (dt_us == 0) return;
+    enc->dt_us = dt_us;
+    enc->pre_time_us = now_us;
+
+    // dt is measured, so one integer divide: pulses * 60e9 / (PULSE_PER_REVOLUTION * dt_us)
+    int32_t diffPulse = 0;
+    updateDiffPulse(enc, &diffPulse);
+    updateSpeed(enc, mode4X, (int32_t)((int64_t)diffPulse * 60000000000LL / ((int64_t)PULSE_PER_REVOLUTION * dt_us)));
+}
+
+void Encoder_Init(Encoder *p1, platform_timer *h_time)
 {
+    p1->_mRPM = 0;
     p1->_RPM = 0;
     p1->_PWM = 0;
     p1->pre_counter = 0;
+    p1->pre_time_us = platform_micros();
+    p1->dt_us = 0;
     p1->htim = h_time;
-    if (HAL_TIM_Encoder_Start(p1->htim, TIM_CHANNEL_ALL) != HAL_OK)
+    if (!platform_timer_start_encoder(p1->htim))
         Error_Handler(); // write in main.c, maybe turn some led on?
 }
@@ -13,14 +13,22 @@
 #define MAX_RPM 200
 #define PULSE_PER_REVOLUTION 1050
 
+// speed is integer math only (ISR safe, no double on a single precision FPU)
+// milli RPM per pulse in one TIME_SAMPLING, Q16: 60 s * 1000 ms * 1000 / (PULSE_PER_REVOLUTION * TIME_SAMPLING)
+#define ENCODER_MRPM_PER_PULSE_Q16 ((60000000LL * 65536 + PULSE_PER_REVOLUTION * TIME_SAMPLING / 2) / (PULSE_PER_REVOLUTION * TIME_SAMPLING))
+// PWM per milli RPM, Q24: MAX_PID_VALUE / (MAX_RPM * 1000)
+#define ENCODER_PWM_PER_MRPM_Q24 (((long long)MAX_PID_VALUE << 24) / (MAX_RPM * 1000LL))
 
 typedef struct
 {
-    volatile double _RPM;
-    volatile double _PWM;
+    volatile int32_t _mRPM;             // milli RPM
+    volatile int32_t _RPM;              // _mRPM / 1000, rounded to nearest
+    volatile int32_t _PWM;              // speed as PWM: MAX_RPM is MAX_PID_VALUE
     volatile uint32_t pre_counter;
+    volatile uint32_t pre_time_us;      // platform_micros of the last update
+    volatile uint32_t dt_us;            // time between the last two updates
     int8_t Direction;
-    TIM_HandleTypeDef *htim;
+    platform_timer *htim;
 } Encoder;
 
 
@@ -29,14 +37,22 @@ void updateDiffPulse(Encoder* en, int32_t *diffPulse);
   * @brief  Reset all paramater in Encoder structure
   * @param  *en is pointer to the encoder structure
 */
-void Encoder_Init(Encoder *p1, TIM_HandleTypeDef *h_time);
+void Encoder_Init(Encoder *p1, platform_timer *h_time);
 /**
   * @brief  update all values of encoder
   * @param  htim Timer handle of encoder module
   * @param  *en is pointer to the encoder structure
 */
-void TimerInitENC(TIM_HandleTypeDef *h_time, uint32_t Channel);
+void TimerInitENC(platform_timer *h_time, uint32_t Channel);
 
 void updateEncoder(Encoder *enc, bool mode4X);
 
+/**
+  * @brief  update all values of encoder with the measured time since the last update
+  *         (not TIME_SAMPLING), can be called at any time, e.g. from the main loop
+  * @param  *en is pointer to the encoder structure
+  * @param  now_us is platform_micros() now, enc->dt_us is then the time step for output_PID_dt
+*/
+void updateEncoder_dt(Encoder *enc, bool mode4X, uint32_t now_us);
+
 #endif
@@ -49,8 +49,7 @@ static bool read_8bit_register (uint8_t *value, uint8_t addr)
 	uint8_t rx_buff;
 	tx_buff = (I2C_BMP280_ADDRESS << 1);
 
-	if (HAL_I2C_Mem_Read(BMP280_I2C, tx_buff, addr, 1, rx_buff, 1, i2c_timeout)
-			== HAL_OK)
+	if (platform_i2c_read(BMP280_I2C, tx_buff, addr, &rx_buff, 1, i2c_timeout))
 	{
 		*value = rx_buff;
 		return 1;
@@ -64,8 +63,7 @@ static bool read_16bit_register (uint16_t *value, uint8_t addr)
 	uint8_t rx_buff[2];
 	tx_buff = (I2C_BMP280_ADDRESS << 1);
 
-	if (HAL_I2C_Mem_Read(BMP280_I2C, tx_buff, addr, 1, rx_buff, 2, i2c_timeout)
-			== HAL_OK)
+	if (platform_i2c_read(BMP280_I2C, tx_buff, addr, rx_buff, 2, i2c_timeout))
 	{
 		*value = (uint16_t) ((rx_buff[1] << 8) | rx_buff[0]);
 		return 1;
@@ -76,8 +74,7 @@ static bool read_16bit_register (uint16_t *value, uint8_t addr)
 static bool write_8bit_register (uint8_t *value, uint8_t addr)
 {
 	uint16_t tx_buff = (I2C_BMP280_ADDRESS << 1);
-	if (HAL_I2C_Mem_Write(BMP280_I2C, tx_buff, addr, 1, value, 1, i2c_timeout)
-			== HAL_OK)
+	if (platform_i2c_write(BMP280_I2C, tx_buff, addr, value, 1, i2c_timeout))
 		return 1;
 	else
 		return 0;
@@ -86,8 +83,7 @@ static bool write_8bit_register (uint8_t *value, uint8_t addr)
 static bool read_data (uint8_t * value, uint8_t addr, uint8_t len)
 {
 	uint16_t tx_buff = (I2C_BMP280_ADDRESS << 1);
-	if (HAL_I2C_MEM_Read(BMP280_I2C, tx_buff, addr, 1, value, len, i2c_timeout)
-			== HAL_OK)
+	if (platform_i2c_read(BMP280_I2C, tx_buff, addr, value, len, i2c_timeout))
 		return 1;
 	else
 		return 0;
@@ -114,11 +110,12 @@ static int read_calibration_data(BMP280 * bmp)
 
 bool bmp280_init(BMP280 * bmp, BMP280_setup *setup)
 {
-	if (!write_8bit_register(BMP280_RESET_VALUE, RESET)) return false;
+	uint8_t reset = BMP280_RESET_VALUE;
+	if (!write_8bit_register(&reset, RESET)) return false;
 	while (1) 
 	{
 		uint8_t status;
-		if (!read_data(&status, STATUS, 1)
+		if (read_8bit_register(&status, STATUS)
 			&& (status & 1) == 0)
 				break;
 	}
@@ -136,7 +133,7 @@ bool bmp280_init(BMP280 * bmp, BMP280_setup *setup)
 bool is_measurement_done()
 {
 	uint8_t status;
-	if (!read_data(&status, STATUS, 1))
+	if (!read_8bit_register(&status, STATUS))
 		return false;
 	return (status & (1 << 3)) == 0;
 }
@@ -8,13 +8,13 @@
 #ifndef INC_GY_BMP280_H_
 #define INC_GY_BMP280_H_
 
-#include "main.h"
+#include "../Platform/platform.h"
 #include <stdint.h>
 #include <math.h>
 #include <stdbool.h>
 
 /* User Configurations */
-extern I2C_HandleTypeDef 				 hi2c1;
+extern platform_i2c 					 hi2c1;
 #define BMP280_I2C 						(&hi2c1)
 
 /* End User Configurations */
@@ -11,8 +11,7 @@ float digital_resolution[8] = {0.73, 0.92, 1.22, 1.52, 2.27, 2.56, 3.03, 4.35};
 // Write byte to register
 static bool HMC5883L_writeRegister8(uint8_t reg, uint8_t value)
 {
-    if (HAL_I2C_Mem_Write(HMC5883L_I2C, HMC5883L_DEFAULT_ADDRESS, reg, 1, &value, 1, I2C_TIMEOUT)
-            == HAL_OK)
+    if (platform_i2c_write(HMC5883L_I2C, HMC5883L_DEFAULT_ADDRESS, reg, &value, 1, I2C_TIMEOUT))
         return true;
     return false;
 }
@@ -20,8 +19,7 @@ static bool HMC5883L_writeRegister8(uint8_t reg, uint8_t value)
 // Read byte from register
 static bool HMC5883L_readRegister8(uint8_t reg, uint8_t * value)
 {
-    if (HAL_I2C_Mem_Read(HMC5883L_I2C, HMC5883L_DEFAULT_ADDRESS, reg, 1, value, 1, I2C_TIMEOUT)
-            == HAL_OK)
+    if (platform_i2c_read(HMC5883L_I2C, HMC5883L_DEFAULT_ADDRESS, reg, value, 1, I2C_TIMEOUT))
         return true;
     return false;
 }
@@ -30,8 +28,7 @@ static bool HMC5883L_readRegister8(uint8_t reg, uint8_t * value)
 static bool HMC5883L_readRegister16(uint8_t reg, int16_t * value)
 {
     uint8_t raw[2];
-    if (HAL_I2C_Mem_Read(HMC5883L_I2C, HMC5883L_DEFAULT_ADDRESS, reg, 1, raw, 2, I2C_TIMEOUT)
-            == HAL_OK)
+    if (platform_i2c_read(HMC5883L_I2C, HMC5883L_DEFAULT_ADDRESS, reg, raw, 2, I2C_TIMEOUT))
     {
         *value =  ((int16_t) raw[0] << 8 | raw[1]);
         return true;
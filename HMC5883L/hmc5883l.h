@@ -8,13 +8,13 @@
 #ifndef INC_HMC5883L_H_
 #define INC_HMC5883L_H_
 
-#include "main.h"
+#include "../Platform/platform.h"
 #include <math.h>
 #include <stdbool.h>
 #include <stdint.h>
 
 /* User Configurations */
-extern  I2C_HandleTypeDef 				 hi2c1;
+extern  platform_i2c 					 hi2c1;
 #define HMC5883L_I2C 					    (&hi2c1)
 /* Get declination tutorial 
 Visit the NOAA Website: Go to the NOAA Magnetic Field Calculators (https://www.ngdc.noaa.gov/geomag/calculators/magcalc.shtml).
@@ -12,25 +12,25 @@ uint8_t mpu6050_init(MPU_6050 * mpu)
 	uint8_t data;
 	uint8_t mpu_check;
 
-	HAL_I2C_Mem_Read(MPU6050_I2C, MPU6050_ADDR, WHO_AM_I, 1, &mpu_check, 1, i2c_timeout);
+	platform_i2c_read(MPU6050_I2C, MPU6050_ADDR, WHO_AM_I, &mpu_check, 1, i2c_timeout);
 
 	if (mpu_check == 0x68) // default value
 	{
 		// Power up the device
 		data = 0x00;
-		HAL_I2C_Mem_Write(MPU6050_I2C, MPU6050_ADDR, PWR_MGMT_1, 1, &data, 1, i2c_timeout);
+		platform_i2c_write(MPU6050_I2C, MPU6050_ADDR, PWR_MGMT_1, &data, 1, i2c_timeout);
 		// Turn on Low pass filter
 		data = 0x05;
-		HAL_I2C_Mem_Write(MPU6050_I2C, MPU6050_ADDR, CONFIG, 1, &data, 1, i2c_timeout);
+		platform_i2c_write(MPU6050_I2C, MPU6050_ADDR, CONFIG, &data, 1, i2c_timeout);
 		// Set up Gyro's Full scale rate +- 500 */s
 		data = 0x08;
-		HAL_I2C_Mem_Write(MPU6050_I2C, MPU6050_ADDR, GYRO_CONFIG, 1, &data, 1, i2c_timeout);
+		platform_i2c_write(MPU6050_I2C, MPU6050_ADDR, GYRO_CONFIG, &data, 1, i2c_timeout);
 		// Set up Acceler's Full scale rate +- 8g
 		data = 0x10;
-		HAL_I2C_Mem_Write(MPU6050_I2C, MPU6050_ADDR, ACCEL_CONFIG, 1, &data, 1, i2c_timeout);
+		platform_i2c_write(MPU6050_I2C, MPU6050_ADDR, ACCEL_CONFIG, &data, 1, i2c_timeout);
 		// Set up sampling rate to 1kHz
 		data = 0x00;
-		HAL_I2C_Mem_Write(MPU6050_I2C, MPU6050_ADDR, SMPLRT_DIV, 1, &data, 1, i2c_timeout);
+		platform_i2c_write(MPU6050_I2C, MPU6050_ADDR, SMPLRT_DIV, &data, 1, i2c_timeout);
 		// get reference point
 		get_ref_point(mpu);
 
@@ -60,7 +60,7 @@ void get_ref_point(MPU_6050 * mpu)
 		ref_x += mpu->rateRoll;
 		ref_y += mpu->ratePitch;
 		ref_z += mpu->rateYaw;
-		HAL_Delay(1); // sampling time is 1kHz (1 ms)
+		platform_delay_ms(1); // sampling time is 1kHz (1 ms)
 	}
 	mpu->ref_point_X = ref_x / TIME_REF;
 	mpu->ref_point_Y = ref_y / TIME_REF;
@@ -78,7 +78,7 @@ void mpu6050_update_all(MPU_6050 * mpu)
 {
 	uint8_t half_data[6];
 	// read raw value of x,y,z gyro into half_data
-	HAL_I2C_Mem_Read(MPU6050_I2C, MPU6050_ADDR, GYRO_XOUT_H, 1, half_data, 6, i2c_timeout);
+	platform_i2c_read(MPU6050_I2C, MPU6050_ADDR, GYRO_XOUT_H, half_data, 6, i2c_timeout);
 	// concat data
 	concat_raw_data(mpu, half_data);
 	// convert to physical data and calibrate
@@ -89,7 +89,7 @@ void mpu6050_update_all(MPU_6050 * mpu)
 	if (mpu->ref_point_X)
 	{
 		// read raw value of x,y,z accel into half_data
-		HAL_I2C_Mem_Read(MPU6050_I2C, MPU6050_ADDR, ACCEL_XOUT_H, 1, half_data, 6, i2c_timeout);
+		platform_i2c_read(MPU6050_I2C, MPU6050_ADDR, ACCEL_XOUT_H, half_data, 6, i2c_timeout);
 		// concat data
 		concat_raw_data(mpu, half_data);
 		// convert to physical data
@@ -8,13 +8,13 @@
 #ifndef INC_MPU6050_H_
 #define INC_MPU6050_H_
 
-#include "main.h"
+#include "../Platform/platform.h"
 #include <math.h>
 /* 										User notes  						   */
 /* Must to set up interrupt or anything for sampling time equal to your define */
 /*******************************************************************************/
 /* User Configurations */
-extern I2C_HandleTypeDef 				 hi2c1;
+extern platform_i2c 					 hi2c1;
 #define MPU6050_I2C 					(&hi2c1)
 // calibration to reach 1g for accelerometer
 #define CALIB_Ax_VALUE 0.01
@@ -0,0 +1,154 @@
+#include "motion_profile.h"
+#include <math.h>
+#include <string.h>
+
+void set_motion_limits(motion_profile *profile, profile_type type, float max_vel, float max_acc, float max_jerk, float dt)
+{
+    memset(profile, 0, sizeof(motion_profile));
+    profile->type = type;
+    profile->max_vel = max_vel;
+    profile->max_acc = max_acc;
+    profile->max_jerk = max_jerk;
+    profile->dt = dt;
+    profile->segment = MOTION_SEGMENTS;
+}
+
+// acceleration phase of the trapezoid: time at max_acc and peak velocity for distance d
+static void plan_trapezoid(motion_profile *profile, float d, float *t_acc, float *t_cruise, float *a)
+{
+    float v = profile->max_vel;
+    *a = profile->max_acc;
+
+    if (d * *a < v * v)
+    {
+        v = sqrtf(d * *a);        // triangle, max_vel not reached
+    }
+    *t_acc = v / *a;
+    *t_cruise = (d - v * v / *a) / v;
+    if (*t_cruise < 0) *t_cruise = 0;
+}
+
+// S curve: jerk time, constant acceleration time, cruise time and peak acceleration for distance d
+static void plan_scurve(motion_profile *profile, float d, float *t_jerk, float *t_acc, float *t_cruise, float *a)
+{
+    float v = profile->max_vel;
+    float j = profile->max_jerk;
+    *a = profile->max_acc;
+
+    // velocity and acceleration reached: acceleration phase covers v * (v / a + a / j)
+    if (v * j < *a * *a) *a = sqrtf(v * j);       // max_acc not reached before max_vel
+    if (v * (v / *a + *a / j) > d)
+    {
+        // max_vel not reached: largest v with v^2 / a + v * a / j = d
+        float a_max = profile->max_acc;
+        v = a_max * (-a_max / j + sqrtf(a_max * a_max / (j * j) + 4.0f * d / a_max)) / 2.0f;
+        *a = a_max;
+        if (v * j < a_max * a_max)
+        {
+            // max_acc not reached either: acceleration is a triangle, d = 2 * j * t_jerk^3
+            float tj = cbrtf(d / (2.0f * j));
+            *a = j * tj;
+            v = j * tj * tj;
+        }
+    }
+
+    *t_jerk = *a / j;
+    *t_acc = v / *a - *t_jerk;
+    if (*t_acc < 0) *t_acc = 0;
+    *t_cruise = (d - v * (v / *a + *a / j)) / v;
+    if (*t_cruise < 0) *t_cruise = 0;
+}
+
+void start_motion(motion_profile *profile, float start, float target)
+{
+    float d = fabsf(target - start);
+    float sign = (target >= start) ? 1.0f : -1.0f;
+    float t_jerk = 0, t_acc, t_cruise, a;
+
+    profile->pos = start;
+    profile->vel = 0;
+    profile->acc = 0;
+    profile->target = target;
+    profile->segment = MOTION_SEGMENTS;
+    profile->segment_time = 0;
+    memset(profile->duration, 0, sizeof(profile->duration));
+    if (d <= 0.0f) return;
+
+    if (profile->type == PROFILE_SCURVE) plan_scurve(profile, d, &t_jerk, &t_acc, &t_cruise, &a);
+    else plan_trapezoid(profile, d, &t_acc, &t_cruise, &a);
+
+    // jerk up, constant acc, jerk down, cruise, jerk down, constant dec, jerk up
+    const float duration[MOTION_SEGMENTS] = {t_jerk, t_acc, t_jerk, t_cruise, t_jerk, t_acc, t_jerk};
+    const float jerk[MOTION_SEGMENTS] = {1, 0, -1, 0, -1, 0, 1};
+    const float acc_start[MOTION_SEGMENTS] = {0, 1, 1, 0, 0, -1, -1};
+    bool scurve = profile->type == PROFILE_SCURVE;
+
+    for (uint8_t i = 0; i < MOTION_SEGMENTS; i++)
+    {
+        profile->duration[i] = duration[i];
+        profile->jerk[i] = scurve ? sign * jerk[i] * profile->max_jerk : 0.0f;
+        profile->acc_start[i] = sign * acc_start[i] * a;
+    }
+    profile->segment = 0;
+    profile->segment_pos = start;
+    profile->segment_vel = 0;
+}
+
+// setpoints t seconds into segment s, from the state at its start (no error adds up over a long segment)
+static void evaluate(motion_profile *profile, uint8_t s, float t)
+{
+    float a0 = profile->acc_start[s];
+    float j = profile->jerk[s];
+
+    profile->pos = profile->segment_pos + profile->segment_vel * t + a0 * t * t / 2.0f + j * t * t * t / 6.0f;
+    profile->vel = profile->segment_vel + a0 * t + j * t * t / 2.0f;
+    profile->acc = a0 + j * t;
+}
+
+bool update_motion(motion_profile *profile)
+{
+    float t = profile->segment_time + profile->dt;
+
+    while (profile->segment < MOTION_SEGMENTS)
+    {
+        uint8_t s = profile->segment;
+
+        if (t < profile->duration[s])
+        {
+            evaluate(profile, s, t);
+            profile->segment_time = t;
+            return true;
+        }
+
+        // end of this segment is the start of the next one, the rest of the tick goes there
+        evaluate(profile, s, profile->duration[s]);
+        profile->segment_pos = profile->pos;
+        profile->segment_vel = profile->vel;
+        t -= profile->duration[s];
+        profile->segment++;
+        profile->segment_time = 0;
+    }
+
+    // done: remove the rounding of the segment ends
+    profile->pos = profile->target;
+    profile->vel = 0;
+    profile->acc = 0;
+    return false;
+}
+
+int16_t motion_feed_forward(const motion_profile *profile, float kv, float ka)
+{
+    float ff = kv * profile->vel + ka * profile->acc;
+
+    if (ff > INT16_MAX) return INT16_MAX;
+    if (ff < INT16_MIN) return INT16_MIN;
+    return (int16_t)ff;
+}
+
+float motion_duration(const motion_profile *profile)
+{
+    float total = 0;
+
+    for (uint8_t i = 0; i < MOTION_SEGMENTS; i++) total += profile->duration[i];
+    return total;
+}
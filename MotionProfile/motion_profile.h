@@ -0,0 +1,93 @@
+#ifndef _MOTION_PROFILE_H_
+#define _MOTION_PROFILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+  Point to point motion profile: position / velocity / acceleration setpoints for a move
+  from rest to rest, instead of a step which saturates the PID and winds up the integrator
+    PROFILE_TRAPEZOID: acceleration limited (velocity is a trapezoid or a triangle)
+    PROFILE_SCURVE:    acceleration and jerk limited (7 segments), no step in acceleration
+  The move is planned once in start_motion (closed form), update_motion advances one
+  control tick in O(1): at most the end of one segment and the start of the next per call.
+  Units are free (pulses, mm, deg): limits are unit/s, unit/s^2, unit/s^3.
+
+  Example (position loop at 20Hz in encoder pulses, with feed forward):
+      motion_profile move;
+      set_motion_limits(&move, PROFILE_SCURVE, 2000.0f, 4000.0f, 20000.0f, TIME_SAMPLING / 1000.0f);
+      start_motion(&move, position, position + 5000);
+
+      // throw into HAL_TIM_PeriodElapsedCallback
+      update_motion(&move);
+      output_PID_2dof(&pid, move.pos, position, motion_feed_forward(&move, 0.1f, 0.01f), 1000 / TIME_SAMPLING);
+*/
+
+/* User Configurations */
+#define MOTION_SEGMENTS 7
+/* End User Configurations */
+
+typedef enum
+{
+    PROFILE_TRAPEZOID = 0,
+    PROFILE_SCURVE
+} profile_type;
+
+typedef struct
+{
+    profile_type type;
+    float max_vel;
+    float max_acc;
+    float max_jerk;              // S curve only
+    float dt;                    // s per update_motion call
+
+    // plan: per segment duration, jerk and acceleration at its start
+    float duration[MOTION_SEGMENTS];
+    float jerk[MOTION_SEGMENTS];
+    float acc_start[MOTION_SEGMENTS];
+    float target;
+
+    // setpoints now
+    float pos;
+    float vel;
+    float acc;
+    uint8_t segment;             // MOTION_SEGMENTS when done
+    float segment_time;          // s spent in the current segment
+    float segment_pos;           // pos and vel at the start of the current segment
+    float segment_vel;
+} motion_profile;
+
+/**
+  * @brief  set profile type and limits (the profile is idle at 0 after it)
+  * @param  *profile is pointer to the motion profile structure
+  * @param  type is PROFILE_TRAPEZOID or PROFILE_SCURVE
+  * @param  max_vel, max_acc, max_jerk are limits (max_jerk unused by the trapezoid), all > 0
+  * @param  dt is time between two update_motion calls in s
+*/
+void set_motion_limits(motion_profile *profile, profile_type type, float max_vel, float max_acc, float max_jerk, float dt);
+
+/**
+  * @brief  plan a move from rest at start to rest at target
+  * @note   a new move while one runs starts again from rest at start, stop first or
+  *         use the current profile->pos as start once the move is done
+*/
+void start_motion(motion_profile *profile, float start, float target);
+
+/**
+  * @brief  advance the setpoints by one control tick
+  * @return false once the move is done (pos = target, vel = acc = 0)
+*/
+bool update_motion(motion_profile *profile);
+
+/**
+  * @brief  feed forward of the current setpoint: kv * vel + ka * acc
+  * @note   for the feed_forward input of output_PID_2dof
+*/
+int16_t motion_feed_forward(const motion_profile *profile, float kv, float ka);
+
+/**
+  * @brief  total time of the planned move in s
+*/
+float motion_duration(const motion_profile *profile);
+
+#endif
@@ -15,6 +15,33 @@ void reset_PID_gain(PID_instance *PID)
     PID->d_gain = 0.0;
     PID->pre_error = 0;
     PID->isSaturation = false;
+    PID->beta = 1.0;
+    PID->gamma = 0.0;
+    PID->d_alpha = 1.0;
+    PID->d_filtered = 0.0;
+    PID->pre_d_input = 0.0;
+    PID->integral_time = 0.0;
+    PID->integral_gain = 0.0;
+    return;
+}
+
+void set_PID_weight(PID_instance *PID, float beta, float gamma)
+{
+    PID->beta = beta;
+    PID->gamma = gamma;
+    return;
+}
+
+void set_PID_filter(PID_instance *PID, float cutoff_hz, uint16_t sampling_rate)
+{
+    if (cutoff_hz <= 0.0f)
+    {
+        PID->d_alpha = 1.0;
+        return;
+    }
+    // alpha = dt / (tau + dt), tau = 1 / (2 * pi * fc)
+    float dt = 1.0f / sampling_rate;
+    PID->d_alpha = dt / (1.0f / (2.0f * 3.14159265f * cutoff_hz) + dt);
     return;
 }
 
@@ -22,7 +49,8 @@ void reset_PID_gain(PID_instance *PID)
 void output_PID(PID_instance *PID, int16_t error_input, uint16_t sampling_rate)
 {
     float value_I = 0.0;
-    if (!PID->isSaturation)
+    // i_gain 0: integral is held, it does not wind up unseen (gain scheduling brings it back)
+    if (!PID->isSaturation && PID->i_gain != 0.0f)
     {
         PID->integral_error += error_input;
         value_I = PID->i_gain * PID->integral_error / sampling_rate;
@@ -31,14 +59,73 @@ void output_PID(PID_instance *PID, int16_t error_input, uint16_t sampling_rate)
     
     constrain(&(PID->integral_error), -MAX_INTEGRAL, MAX_INTEGRAL);
     
-    PID->output_PID = PID->p_gain * error_input 
-                    + value_I
-                    + PID->d_gain * (error_input - PID->pre_error) * sampling_rate;
+    int32_t output = PID->p_gain * error_input 
+                   + value_I
+                   + PID->d_gain * (error_input - PID->pre_error) * sampling_rate;
 
-    int16_t raw_value = PID->output_PID;
-    constrain(&(PID->output_PID), -MAX_PID_VALUE, MAX_PID_VALUE);
+    int32_t raw_value = output;
+    constrain(&output, -MAX_PID_VALUE, MAX_PID_VALUE);
+    PID->output_PID = output;
     
-    PID->isSaturation = (raw_value != PID->output_PID) && (raw_value * error_input > 0); //check saturation and same sign
+    PID->isSaturation = (raw_value != output) && ((raw_value > 0 && error_input > 0) || (raw_value < 0 && error_input < 0)); //check saturation and same sign
+    PID->pre_error = error_input;
+
+    return;
+}
+
+void output_PID_dt(PID_instance *PID, int16_t error_input, uint32_t dt_us)
+{
+    // jitter of the tick changes dt, not the gains: I uses error * dt, D uses d(error) / dt
+    float dt = dt_us / 1000000.0f;
+    if (!PID->isSaturation && PID->i_gain != 0.0f)
+    {
+        PID->integral_time += error_input * dt;
+        if (PID->integral_time > MAX_INTEGRAL / 1000.0f) PID->integral_time = MAX_INTEGRAL / 1000.0f;
+        if (PID->integral_time < -MAX_INTEGRAL / 1000.0f) PID->integral_time = -MAX_INTEGRAL / 1000.0f;
+    }
+    float value_I = PID->i_gain * PID->integral_time;
+    float value_D = 0.0;
+    if (dt_us) value_D = PID->d_gain * (error_input - PID->pre_error) / dt;
+
+    int32_t output = PID->p_gain * error_input
+                   + value_I
+                   + value_D;
+
+    int32_t raw_value = output;
+    constrain(&output, -MAX_PID_VALUE, MAX_PID_VALUE);
+    PID->output_PID = output;
+
+    PID->isSaturation = (raw_value != output) && ((raw_value > 0 && error_input > 0) || (raw_value < 0 && error_input < 0));
+    PID->pre_error = error_input;
+
+    return;
+}
+
+void output_PID_2dof(PID_instance *PID, int16_t setpoint, int16_t measurement, int16_t feed_forward, uint16_t sampling_rate)
+{
+    int16_t error_input = setpoint - measurement;
+    float value_I = PID->i_gain * PID->integral_error / sampling_rate;
+    if (!PID->isSaturation && PID->i_gain != 0.0f)
+    {
+        PID->integral_error += error_input;
+        constrain(&(PID->integral_error), -MAX_INTEGRAL, MAX_INTEGRAL);
+        value_I = PID->i_gain * PID->integral_error / sampling_rate;
+    }
+
+    float d_input = PID->gamma * setpoint - measurement;
+    PID->d_filtered += PID->d_alpha * ((d_input - PID->pre_d_input) * sampling_rate - PID->d_filtered);
+    PID->pre_d_input = d_input;
+
+    int32_t output = PID->p_gain * (PID->beta * setpoint - measurement)
+                   + value_I
+                   + PID->d_gain * PID->d_filtered
+                   + feed_forward;
+
+    int32_t raw_value = output;
+    constrain(&output, -MAX_PID_VALUE, MAX_PID_VALUE);
+    PID->output_PID = output;
+
+    PID->isSaturation = (raw_value != output) && ((raw_value > 0 && error_input > 0) || (raw_value < 0 && error_input < 0));
     PID->pre_error = error_input;
 
     return;
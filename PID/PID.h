@@ -17,6 +17,16 @@ typedef struct
     int32_t integral_error;
     int16_t output_PID;
     bool isSaturation;
+    // two degree of freedom mode (output_PID_2dof)
+    float beta;             // setpoint weight of P, 1 = error
+    float gamma;            // setpoint weight of D, 0 = derivative on measurement
+    float d_alpha;          // low pass of D term, 1 = no filter
+    float d_filtered;
+    float pre_d_input;
+    // measured time step mode (output_PID_dt)
+    float integral_time;    // sum of error * dt in error * s
+    // gain scheduling (schedule_PID_gain)
+    float integral_gain;    // i_gain the integral is scaled for, kept while i_gain is 0
 } PID_instance;
 
 /**
@@ -39,5 +49,54 @@ void set_PID_gain(PID_instance *PID, float p, float i, float d);
 */
 void output_PID(PID_instance *PID, int16_t error_input, uint16_t sampling_rate);
 
+/**
+  * @brief  set output for PID structure with measured time since the last update
+  * @param  *PID is pointer to the PID structure
+  * @param  error_input is error input which you need to fix it
+  * @param  dt_us is time since the last update in us (e.g. difference of platform_micros)
+  * @note   the integral is integral_time (error * s), limited to MAX_INTEGRAL / 1000
+  * @note   with i_gain 0 the integral is held (as in output_PID and output_PID_2dof)
+*/
+void output_PID_dt(PID_instance *PID, int16_t error_input, uint32_t dt_us);
+
+/*
+  Two degree of freedom mode: setpoint and measurement are given apart
+      P = p_gain * (beta * setpoint - measurement)
+      I = i_gain * sum(setpoint - measurement) (same integral and anti windup as output_PID)
+      D = d_gain * lowpass(d/dt (gamma * setpoint - measurement))
+      output = P + I + D + feed_forward
+  gamma = 0 removes the kick of a setpoint step, the low pass removes encoder quantization
+  noise, so P and D gains can go higher than with output_PID
+
+  Example (speed loop at 20Hz, D filtered at 3Hz):
+      reset_PID_gain(&pid);
+      set_PID_gain(&pid, 2.0f, 0.5f, 0.05f);
+      set_PID_weight(&pid, 0.8f, 0.0f);
+      set_PID_filter(&pid, 3.0f, 1000 / TIME_SAMPLING);
+      output_PID_2dof(&pid, target_RPM, enc._RPM, 0, 1000 / TIME_SAMPLING);
+*/
+
+/**
+  * @brief  set setpoint weights of output_PID_2dof
+  * @param  beta is weight of setpoint in P (0..1)
+  * @param  gamma is weight of setpoint in D (0..1), 0 is derivative on measurement
+*/
+void set_PID_weight(PID_instance *PID, float beta, float gamma);
+
+/**
+  * @brief  set first order low pass of D term of output_PID_2dof
+  * @param  cutoff_hz is cut off frequency, 0 disables the filter
+  * @param  sampling_rate is number of updates per second
+*/
+void set_PID_filter(PID_instance *PID, float cutoff_hz, uint16_t sampling_rate);
+
+/**
+  * @brief  set output for PID structure in two degree of freedom mode
+  * @param  setpoint, measurement are in the unit of error_input of output_PID
+  * @param  feed_forward is added to the output before the limit (e.g. from a motion profile)
+  * @param  sampling_rate is number of updates per second
+*/
+void output_PID_2dof(PID_instance *PID, int16_t setpoint, int16_t measurement, int16_t feed_forward, uint16_t sampling_rate);
+
 #endif 
 /*PID_CONTROL_H_*/
@@ -0,0 +1,116 @@
+#include "pid_autotune.h"
+#include <math.h>
+
+void start_autotune(pid_autotune *tuner, int16_t setpoint, int16_t bias, int16_t amplitude,
+                    int16_t hysteresis, uint16_t sampling_rate, uint16_t timeout_s)
+{
+    tuner->setpoint = setpoint;
+    tuner->bias = bias;
+    tuner->amplitude = amplitude;
+    tuner->hysteresis = hysteresis;
+    tuner->sampling_rate = sampling_rate;
+    tuner->timeout = (uint32_t)timeout_s * sampling_rate;
+    tuner->relay_high = true;
+    tuner->tick = 0;
+    tuner->last_rise = 0;
+    tuner->peak_max = INT16_MIN;
+    tuner->peak_min = INT16_MAX;
+    tuner->cycles = 0;
+    tuner->peak_sum = 0;
+    tuner->period_sum = 0;
+    tuner->ku = 0;
+    tuner->tu = 0;
+    tuner->output = bias + amplitude;
+    tuner->state = AUTOTUNE_RUNNING;
+}
+
+static void finish_autotune(pid_autotune *tuner)
+{
+    float a = tuner->peak_sum / AUTOTUNE_CYCLES;
+    float h = tuner->hysteresis;
+
+    if (a <= h)
+    {
+        tuner->state = AUTOTUNE_FAILED;
+        return;
+    }
+    tuner->ku = 4.0f * tuner->amplitude / (3.14159265f * sqrtf(a * a - h * h));
+    tuner->tu = (float)tuner->period_sum / AUTOTUNE_CYCLES / tuner->sampling_rate;
+    tuner->state = AUTOTUNE_DONE;
+}
+
+int16_t update_autotune(pid_autotune *tuner, int16_t measurement)
+{
+    if (tuner->state != AUTOTUNE_RUNNING) return tuner->output;
+
+    tuner->tick++;
+    if (measurement > tuner->peak_max) tuner->peak_max = measurement;
+    if (measurement < tuner->peak_min) tuner->peak_min = measurement;
+
+    if (tuner->relay_high && measurement > tuner->setpoint + tuner->hysteresis)
+    {
+        tuner->relay_high = false;
+    }
+    else if (!tuner->relay_high && measurement < tuner->setpoint - tuner->hysteresis)
+    {
+        // one full cycle ends at every switch to high
+        tuner->relay_high = true;
+        if (tuner->last_rise)
+        {
+            tuner->cycles++;
+            if (tuner->cycles > AUTOTUNE_SKIP_CYCLES)
+            {
+                tuner->peak_sum += (tuner->peak_max - tuner->peak_min) / 2.0f;
+                tuner->period_sum += tuner->tick - tuner->last_rise;
+            }
+        }
+        tuner->last_rise = tuner->tick;
+        tuner->peak_max = measurement;
+        tuner->peak_min = measurement;
+
+        if (tuner->cycles >= AUTOTUNE_SKIP_CYCLES + AUTOTUNE_CYCLES)
+        {
+            finish_autotune(tuner);
+            tuner->output = tuner->bias;
+            return tuner->output;
+        }
+    }
+
+    if (tuner->tick >= tuner->timeout)
+    {
+        tuner->state = AUTOTUNE_FAILED;
+        tuner->output = tuner->bias;
+        return tuner->output;
+    }
+
+    tuner->output = tuner->relay_high ? tuner->bias + tuner->amplitude : tuner->bias - tuner->amplitude;
+    return tuner->output;
+}
+
+bool apply_autotune(pid_autotune *tuner, PID_instance *PID, autotune_rule rule)
+{
+    float kp, ti, td;
+
+    if (tuner->state != AUTOTUNE_DONE) return false;
+
+    if (rule == AUTOTUNE_TYREUS_LUYBEN)
+    {
+        kp = tuner->ku / 2.2f;
+        ti = 2.2f * tuner->tu;
+        td = tuner->tu / 6.3f;
+    }
+    else
+    {
+        kp = 0.6f * tuner->ku;
+        ti = tuner->tu / 2.0f;
+        td = tuner->tu / 8.0f;
+    }
+
+    // output_PID divides the integral by the rate and multiplies the difference by it: gains are per s and s
+    reset_PID_gain(PID);
+    set_PID_gain(PID, kp, kp / ti, kp * td);
+    PID->integral_error = 0;
+    PID->output_PID = 0;
+    tuner->state = AUTOTUNE_IDLE;
+    return true;
+}
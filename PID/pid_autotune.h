@@ -0,0 +1,106 @@
+#ifndef PID_AUTOTUNE_H_
+#define PID_AUTOTUNE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "PID.h"
+
+/*
+  Relay feedback auto tuning (Astrom - Hagglund)
+  The controller is replaced by a relay: output = bias + amplitude while the measurement is
+  under setpoint, bias - amplitude above it (with hysteresis). The plant oscillates at its
+  ultimate period Tu, the oscillation amplitude a gives the ultimate gain
+      Ku = 4 * amplitude / (pi * sqrt(a^2 - hysteresis^2))
+  Gains come from Ku and Tu with Ziegler - Nichols or Tyreus - Luyben (less overshoot)
+
+  Non blocking: update_autotune is called from the control tick instead of output_PID,
+  it never waits and returns the output to apply.
+
+  Example (speed loop of one motor, relay of +-300 around 400):
+      pid_autotune tuner;
+      start_autotune(&tuner, 100, 400, 300, 2, 1000 / TIME_SAMPLING, 30);
+
+      // throw into HAL_TIM_PeriodElapsedCallback, instead of output_PID
+      updateEncoder(&enc, false);
+      if (tuner.state == AUTOTUNE_RUNNING)
+      {
+          int16_t out = update_autotune(&tuner, enc._RPM);
+          set_motor(&motor, out >= 0 ? FORWARD : BACKWARD, abs(out));
+      }
+      else if (tuner.state == AUTOTUNE_DONE)
+      {
+          apply_autotune(&tuner, &pid, AUTOTUNE_TYREUS_LUYBEN);   // back to output_PID
+      }
+*/
+
+/* User Configurations */
+#define AUTOTUNE_SKIP_CYCLES 2   // first cycles are transient
+#define AUTOTUNE_CYCLES      4   // cycles averaged for Ku and Tu
+/* End User Configurations */
+
+typedef enum
+{
+    AUTOTUNE_IDLE = 0,
+    AUTOTUNE_RUNNING,
+    AUTOTUNE_DONE,
+    AUTOTUNE_FAILED          // timeout: no stable oscillation (relay too small or hysteresis too large)
+} autotune_state;
+
+typedef enum
+{
+    AUTOTUNE_ZIEGLER_NICHOLS = 0,
+    AUTOTUNE_TYREUS_LUYBEN
+} autotune_rule;
+
+typedef struct
+{
+    int16_t setpoint;
+    int16_t bias;
+    int16_t amplitude;
+    int16_t hysteresis;
+    uint16_t sampling_rate;
+    uint32_t timeout;        // ticks
+    volatile autotune_state state;
+    bool relay_high;
+    uint32_t tick;
+    uint32_t last_rise;      // tick of the last switch to high, 0 = none yet
+    int16_t peak_max;
+    int16_t peak_min;
+    uint8_t cycles;
+    float peak_sum;          // sum of (max - min) / 2
+    uint32_t period_sum;     // ticks
+    float ku;
+    float tu;                // s
+    int16_t output;
+} pid_autotune;
+
+/**
+  * @brief  start a relay experiment
+  * @param  *tuner is pointer to the tuner structure
+  * @param  setpoint is operating point of the measurement
+  * @param  bias is output which holds the plant near setpoint
+  * @param  amplitude is relay step around bias (output swings bias +- amplitude)
+  * @param  hysteresis is dead band of the relay in measurement units, larger than the noise
+  * @param  sampling_rate is number of update_autotune calls per second
+  * @param  timeout_s is time before the experiment fails
+*/
+void start_autotune(pid_autotune *tuner, int16_t setpoint, int16_t bias, int16_t amplitude,
+                    int16_t hysteresis, uint16_t sampling_rate, uint16_t timeout_s);
+
+/**
+  * @brief  one control tick of the relay experiment
+  * @param  measurement is the controlled value (same unit as setpoint)
+  * @return output to apply to the plant, also in tuner->output (bias once finished)
+*/
+int16_t update_autotune(pid_autotune *tuner, int16_t measurement);
+
+/**
+  * @brief  compute gains from Ku and Tu and write them into the PID
+  * @param  *PID is pointer to the PID structure, its integral and state are cleared
+  * @param  rule is AUTOTUNE_ZIEGLER_NICHOLS or AUTOTUNE_TYREUS_LUYBEN
+  * @return false if the experiment is not done
+*/
+bool apply_autotune(pid_autotune *tuner, PID_instance *PID, autotune_rule rule);
+
+#endif
+/*PID_AUTOTUNE_H_*/
@@ -0,0 +1,127 @@
+#include "pid_bank.h"
+#include <string.h>
+
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#include "main.h"
+#endif
+
+static uint8_t bank_axes(uint8_t axes)
+{
+    return (axes > PID_BANK_MAX_AXES) ? PID_BANK_MAX_AXES : axes;
+}
+
+void reset_pid_bank_f32(pid_bank_f32 *bank, uint8_t axes)
+{
+    memset(bank, 0, sizeof(pid_bank_f32));
+    bank->axes = bank_axes(axes);
+    for (uint8_t i = 0; i < PID_BANK_MAX_AXES; i++)
+    {
+        bank->integrate[i] = 1.0f;
+    }
+}
+
+void set_pid_bank_f32(pid_bank_f32 *bank, uint8_t axis, float kp, float ki, float kd, float dt, float out_min, float out_max)
+{
+    if (axis >= PID_BANK_MAX_AXES) return;
+
+    bank->kp[axis] = kp;
+    bank->ki_dt[axis] = ki * dt;
+    bank->kd_dt[axis] = kd / dt;
+    bank->out_min[axis] = out_min;
+    bank->out_max[axis] = out_max;
+    bank->integral[axis] = 0.0f;
+    bank->integrate[axis] = 1.0f;
+    bank->pre_error[axis] = 0.0f;
+    bank->out[axis] = 0.0f;
+}
+
+void output_pid_bank_f32(pid_bank_f32 *bank, const float *error)
+{
+    uint8_t axes = bank->axes;  // local copy: a store through bank could alias the uint8_t count
+
+    // selects only: every line maps to one vector instruction over 4 (SSE, NEON) or 8 (AVX) axes
+    for (uint8_t i = 0; i < axes; i++)
+    {
+        float e = error[i];
+
+        float integral = bank->integral[i] + bank->integrate[i] * bank->ki_dt[i] * e;
+        integral = (integral > bank->out_max[i]) ? bank->out_max[i] : integral;
+        integral = (integral < bank->out_min[i]) ? bank->out_min[i] : integral;
+        bank->integral[i] = integral;
+
+        float raw = bank->kp[i] * e + integral + bank->kd_dt[i] * (e - bank->pre_error[i]);
+        float out = (raw > bank->out_max[i]) ? bank->out_max[i] : raw;
+        out = (out < bank->out_min[i]) ? bank->out_min[i] : out;
+
+        // & not &&: a short circuit is a branch and stops the vectorizer
+        bank->integrate[i] = ((raw != out) & (raw * e > 0.0f)) ? 0.0f : 1.0f;
+        bank->pre_error[i] = e;
+        bank->out[i] = out;
+    }
+}
+
+void reset_pid_bank_q15(pid_bank_q15 *bank, uint8_t axes)
+{
+    memset(bank, 0, sizeof(pid_bank_q15));
+    bank->axes = bank_axes(axes);
+}
+
+void set_pid_bank_q15(pid_bank_q15 *bank, uint8_t axis, float kp, float ki, float kd, float dt, int16_t out_min, int16_t out_max)
+{
+    pid_q15 pid;
+
+    if (axis >= PID_BANK_MAX_AXES) return;
+
+    // same quantization as a single controller
+    reset_pid_q15(&pid, kp, ki, kd, dt, out_min, out_max);
+    bank->kp_kd[axis] = (uint16_t)pid.kp | ((uint32_t)(uint16_t)pid.kd_dt << 16);
+    bank->ki_dt[axis] = pid.ki_dt;
+    bank->shift[axis] = pid.shift;
+    bank->out_min[axis] = out_min;
+    bank->out_max[axis] = out_max;
+    bank->integral[axis] = 0;
+    bank->integral_min[axis] = pid.integral_min;
+    bank->integral_max[axis] = pid.integral_max;
+    bank->pre_error[axis] = 0;
+    bank->out[axis] = 0;
+    bank->isSaturation[axis] = false;
+}
+
+void output_pid_bank_q15(pid_bank_q15 *bank, const int16_t *error)
+{
+    for (uint8_t i = 0; i < bank->axes; i++)
+    {
+        int16_t e = error[i];
+        uint8_t n = 15 - bank->shift[i];
+        int32_t d_error = (int32_t)e - bank->pre_error[i];
+        if (d_error > INT16_MAX) d_error = INT16_MAX;
+        if (d_error < INT16_MIN) d_error = INT16_MIN;
+
+        if (!bank->isSaturation[i])
+        {
+            int32_t integral = bank->integral[i] + (int32_t)bank->ki_dt[i] * e;
+            if (integral > bank->integral_max[i]) integral = bank->integral_max[i];
+            if (integral < bank->integral_min[i]) integral = bank->integral_min[i];
+            bank->integral[i] = integral;
+        }
+
+        int64_t acc = bank->integral[i];
+        if (n) acc += 1 << (n - 1);
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+        // kp * e + kd_dt * d_error in one instruction, 64 bits accumulate so nothing wraps
+        acc = __SMLALD(bank->kp_kd[i], __PKHBT(e, d_error, 16), acc);
+#else
+        acc += (int32_t)(int16_t)(bank->kp_kd[i] & 0xFFFF) * e
+             + (int64_t)((int32_t)(int16_t)(bank->kp_kd[i] >> 16) * d_error);
+#endif
+        acc >>= n;
+        int32_t raw = (acc > INT32_MAX) ? INT32_MAX : (acc < INT32_MIN) ? INT32_MIN : (int32_t)acc;
+
+        int16_t out = bank->out_max[i];
+        if (raw < bank->out_max[i]) out = (raw > bank->out_min[i]) ? (int16_t)raw : bank->out_min[i];
+
+        bank->isSaturation[i] = (raw != out) && ((raw > 0) == (e > 0)) && e != 0;
+        bank->pre_error[i] = e;
+        bank->out[i] = out;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef PID_BANK_H_
+#define PID_BANK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pid_fixed.h"
+
+/*
+  Bank of PID controllers updated together (all motors / all axes of one sample)
+  Storage is structure of arrays: one array per gain and per state, indexed by axis,
+  so one call runs the same operations over every axis without pointer chasing
+
+  pid_bank_f32: same law as output_PID with precomputed Ki * dt and Kd / dt, the loop
+                has no branch (selects only) so the host compiler vectorizes it (-O3)
+  pid_bank_q15: same law and rounding as output_pid_q15 (bit exact), on Cortex-M4 the
+                P and D products of one axis are a single dual multiply accumulate into 64 bits (__SMLALD)
+
+  Example (4 wheels, errors from the encoders):
+      pid_bank_q15 wheels;
+      reset_pid_bank_q15(&wheels, 4);
+      for (uint8_t i = 0; i < 4; i++)
+          set_pid_bank_q15(&wheels, i, 2.0f, 10.0f, 0.0005f, 0.01f, -1000, 1000);
+      output_pid_bank_q15(&wheels, error);   // wheels.out[0..3]
+*/
+
+/* User Configurations */
+#define PID_BANK_MAX_AXES 8  // multiple of 4 keeps the host loop fully vectorized
+/* End User Configurations */
+
+typedef struct
+{
+    float kp[PID_BANK_MAX_AXES];
+    float ki_dt[PID_BANK_MAX_AXES];         // Ki * dt
+    float kd_dt[PID_BANK_MAX_AXES];         // Kd / dt
+    float out_min[PID_BANK_MAX_AXES];
+    float out_max[PID_BANK_MAX_AXES];
+    float integral[PID_BANK_MAX_AXES];      // clamped to the output range
+    float integrate[PID_BANK_MAX_AXES];     // 1 or 0 (output saturated in the direction of the error)
+    float pre_error[PID_BANK_MAX_AXES];
+    float out[PID_BANK_MAX_AXES];
+    uint8_t axes;
+} pid_bank_f32;
+
+typedef struct
+{
+    uint32_t kp_kd[PID_BANK_MAX_AXES];      // kp in low half, kd_dt in high half (see pid_q15)
+    int16_t ki_dt[PID_BANK_MAX_AXES];
+    uint8_t shift[PID_BANK_MAX_AXES];
+    int16_t out_min[PID_BANK_MAX_AXES];
+    int16_t out_max[PID_BANK_MAX_AXES];
+    int32_t integral[PID_BANK_MAX_AXES];
+    int32_t integral_min[PID_BANK_MAX_AXES];
+    int32_t integral_max[PID_BANK_MAX_AXES];
+    int16_t pre_error[PID_BANK_MAX_AXES];
+    int16_t out[PID_BANK_MAX_AXES];
+    bool isSaturation[PID_BANK_MAX_AXES];
+    uint8_t axes;
+} pid_bank_q15;
+
+/**
+  * @brief  clear the bank: every axis has zero gains and zero state
+  * @param  *bank is pointer to the bank structure
+  * @param  axes is number of axes updated by output_pid_bank_f32 (max PID_BANK_MAX_AXES)
+*/
+void reset_pid_bank_f32(pid_bank_f32 *bank, uint8_t axes);
+
+/**
+  * @brief  set gains of one axis and clear its state
+  * @param  axis is index of the axis in the bank
+  * @param  kp, ki, kd, dt, out_min, out_max as reset_pid_q15
+*/
+void set_pid_bank_f32(pid_bank_f32 *bank, uint8_t axis, float kp, float ki, float kd, float dt, float out_min, float out_max);
+
+/**
+  * @brief  update every axis of the bank
+  * @param  *bank is pointer to the bank structure
+  * @param  *error is setpoint - measurement of each axis (bank->axes values)
+  * @note   outputs are in bank->out
+*/
+void output_pid_bank_f32(pid_bank_f32 *bank, const float *error);
+
+/**
+  * @brief  clear the bank: every axis has zero gains and zero state
+  * @param  axes is number of axes updated by output_pid_bank_q15 (max PID_BANK_MAX_AXES)
+*/
+void reset_pid_bank_q15(pid_bank_q15 *bank, uint8_t axes);
+
+/**
+  * @brief  set gains of one axis and clear its state (gains are quantized as reset_pid_q15)
+  * @param  axis is index of the axis in the bank
+*/
+void set_pid_bank_q15(pid_bank_q15 *bank, uint8_t axis, float kp, float ki, float kd, float dt, int16_t out_min, int16_t out_max);
+
+/**
+  * @brief  update every axis of the bank
+  * @param  *error is setpoint - measurement of each axis (bank->axes values)
+  * @note   outputs are in bank->out
+*/
+void output_pid_bank_q15(pid_bank_q15 *bank, const int16_t *error);
+
+#endif
+/*PID_BANK_H_*/
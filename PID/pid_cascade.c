@@ -0,0 +1,86 @@
+#include "pid_cascade.h"
+#include <string.h>
+
+// next used stage inside id, PID_CASCADE_STAGES if id is the innermost one
+static uint8_t inner_stage(const pid_cascade *cascade, uint8_t id)
+{
+    for (id++; id < PID_CASCADE_STAGES; id++)
+    {
+        if (cascade->stage[id].divider) break;
+    }
+    return id;
+}
+
+void reset_pid_cascade(pid_cascade *cascade, float base_dt)
+{
+    memset(cascade, 0, sizeof(pid_cascade));
+    cascade->base_dt = base_dt;
+}
+
+void set_pid_cascade_stage(pid_cascade *cascade, pid_cascade_stage_id id, uint16_t divider,
+                           float kp, float ki, float kd, int32_t out_min, int32_t out_max)
+{
+    if (id >= PID_CASCADE_STAGES) return;
+
+    pid_cascade_stage *stage = &cascade->stage[id];
+    stage->divider = divider;
+    stage->setpoint = 0;
+    if (divider) reset_pid_q31(&stage->pid, kp, ki, kd, cascade->base_dt * divider, out_min, out_max);
+    cascade->tick = 0;
+}
+
+void set_pid_cascade_target(pid_cascade *cascade, int32_t target)
+{
+    for (uint8_t id = 0; id < PID_CASCADE_STAGES; id++)
+    {
+        if (cascade->stage[id].divider)
+        {
+            cascade->stage[id].setpoint = target;
+            return;
+        }
+    }
+}
+
+bool pid_cascade_due(const pid_cascade *cascade, pid_cascade_stage_id id)
+{
+    uint16_t divider = cascade->stage[id].divider;
+    return divider && (cascade->tick % divider) == 0;
+}
+
+int32_t pid_cascade_update(pid_cascade *cascade, const int32_t *measurement)
+{
+    uint16_t period = 0;  // divider of the outermost stage, every stage is in phase again after it
+
+    for (uint8_t id = 0; id < PID_CASCADE_STAGES; id++)
+    {
+        pid_cascade_stage *stage = &cascade->stage[id];
+        if (!stage->divider) continue;
+        if (!period) period = stage->divider;
+        if (cascade->tick % stage->divider) continue;
+
+        int64_t difference = (int64_t)stage->setpoint - measurement[id];
+        int32_t error = (difference > INT32_MAX) ? INT32_MAX : (difference < INT32_MIN) ? INT32_MIN : (int32_t)difference;
+
+        uint8_t inner = inner_stage(cascade, id);
+        if (inner < PID_CASCADE_STAGES)
+        {
+            // inner stage pinned at a limit: a larger setpoint in the same direction does nothing,
+            // so the integrator of this stage holds (assumes the inner loop has positive gain)
+            const pid_q31 *inner_pid = &cascade->stage[inner].pid;
+            if ((inner_pid->out >= inner_pid->out_max && error > 0) ||
+                (inner_pid->out <= inner_pid->out_min && error < 0))
+            {
+                stage->pid.isSaturation = true;
+            }
+            cascade->stage[inner].setpoint = output_pid_q31(&stage->pid, error);
+        }
+        else
+        {
+            cascade->out = output_pid_q31(&stage->pid, error);
+        }
+    }
+
+    cascade->tick++;
+    if (cascade->tick >= period) cascade->tick = 0;
+    return cascade->out;
+}
@@ -0,0 +1,103 @@
+#ifndef PID_CASCADE_H_
+#define PID_CASCADE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pid_fixed.h"
+
+/*
+  Cascaded position -> velocity -> current control driven by one timer interrupt
+  pid_cascade_update is called at the base (fastest) rate, every stage runs once per
+  "divider" calls: the current loop every call, the velocity loop e.g. every 10th,
+  the position loop e.g. every 100th. Each outer output is the setpoint of the next
+  enabled inner stage, the innermost output goes to the motor.
+  A stage with divider 0 is not used (e.g. no current sensor: velocity drives the PWM).
+
+  Stages are pid_q31 so every signal is an int32 in the unit you choose
+  (pulses, pulses/s, mA, PWM counts). The range of an outer stage is the limit of the
+  inner setpoint (max speed, max current).
+
+  Anti windup across stages: when an inner stage is pinned to its limit, the outer stage
+  stops integrating in the direction that would push the inner setpoint further.
+
+  Example (TIM at 10kHz: current 10kHz, velocity 1kHz, position 100Hz):
+      pid_cascade axis;
+      reset_pid_cascade(&axis, 1.0f / 10000);
+      set_pid_cascade_stage(&axis, PID_CASCADE_POSITION, 100, 20.0f, 0.0f, 0.0f, -20000, 20000);
+      set_pid_cascade_stage(&axis, PID_CASCADE_VELOCITY, 10, 0.05f, 2.0f, 0.0f, -3000, 3000);
+      set_pid_cascade_stage(&axis, PID_CASCADE_CURRENT, 1, 0.2f, 300.0f, 0.0f, -MAX_PID_VALUE, MAX_PID_VALUE);
+      set_pid_cascade_target(&axis, 5000);
+
+      // throw into HAL_TIM_PeriodElapsedCallback
+      int32_t measurement[PID_CASCADE_STAGES];
+      if (pid_cascade_due(&axis, PID_CASCADE_VELOCITY))
+      {
+          measurement[PID_CASCADE_POSITION] = position;       // pulses
+          measurement[PID_CASCADE_VELOCITY] = speed;          // pulses/s
+      }
+      measurement[PID_CASCADE_CURRENT] = current_mA;
+      int32_t duty = pid_cascade_update(&axis, measurement);
+      set_motor(&motor, duty >= 0 ? FORWARD : BACKWARD, abs(duty));
+*/
+
+typedef enum
+{
+    PID_CASCADE_POSITION = 0,   // outermost
+    PID_CASCADE_VELOCITY,
+    PID_CASCADE_CURRENT,        // innermost
+    PID_CASCADE_STAGES
+} pid_cascade_stage_id;
+
+typedef struct
+{
+    pid_q31 pid;
+    uint16_t divider;           // runs every divider calls, 0 = stage not used
+    int32_t setpoint;           // output of the outer stage (or target for the outermost)
+} pid_cascade_stage;
+
+typedef struct
+{
+    pid_cascade_stage stage[PID_CASCADE_STAGES];
+    float base_dt;              // s between two pid_cascade_update calls
+    uint32_t tick;
+    int32_t out;
+} pid_cascade;
+
+/**
+  * @brief  clear every stage (all unused) and the tick counter
+  * @param  *cascade is pointer to the cascade structure
+  * @param  base_dt is time between two pid_cascade_update calls in s
+*/
+void reset_pid_cascade(pid_cascade *cascade, float base_dt);
+
+/**
+  * @brief  enable one stage and set its gains
+  * @param  id is PID_CASCADE_POSITION, PID_CASCADE_VELOCITY or PID_CASCADE_CURRENT
+  * @param  divider is rate divider of the base rate (1 = every call), must be a multiple
+  *         of the divider of every inner stage used, 0 disables the stage
+  * @param  kp, ki, kd are gains in continuous time, dt of the stage is base_dt * divider
+  * @param  out_min, out_max is output range: setpoint range of the inner stage or motor range
+*/
+void set_pid_cascade_stage(pid_cascade *cascade, pid_cascade_stage_id id, uint16_t divider,
+                           float kp, float ki, float kd, int32_t out_min, int32_t out_max);
+
+/**
+  * @brief  set target of the outermost used stage
+*/
+void set_pid_cascade_target(pid_cascade *cascade, int32_t target);
+
+/**
+  * @brief  check if a stage runs in the next pid_cascade_update call
+  * @note   use it to read only the sensors which are needed this tick
+*/
+bool pid_cascade_due(const pid_cascade *cascade, pid_cascade_stage_id id);
+
+/**
+  * @brief  run the stages which are due, from outer to inner
+  * @param  *measurement is measurement of every stage, only the due ones are read
+  * @return output of the innermost used stage (hold between its runs), also in cascade->out
+*/
+int32_t pid_cascade_update(pid_cascade *cascade, const int32_t *measurement);
+
+#endif
+/*PID_CASCADE_H_*/
@@ -0,0 +1,124 @@
+#include "pid_fixed.h"
+#include <math.h>
+
+static int16_t saturate_q15(int64_t value)
+{
+    if (value > INT16_MAX) return INT16_MAX;
+    if (value < INT16_MIN) return INT16_MIN;
+    return (int16_t)value;
+}
+
+static int32_t saturate_q31(int64_t value)
+{
+    if (value > INT32_MAX) return INT32_MAX;
+    if (value < INT32_MIN) return INT32_MIN;
+    return (int32_t)value;
+}
+
+// smallest exponent which brings every gain below 1
+static uint8_t pid_shift(float kp, float ki_dt, float kd_dt, uint8_t max_shift)
+{
+    float largest = fmaxf(fabsf(kp), fmaxf(fabsf(ki_dt), fabsf(kd_dt)));
+    uint8_t shift = 0;
+
+    while (largest >= 1.0f && shift < max_shift)
+    {
+        largest *= 0.5f;
+        shift++;
+    }
+    return shift;
+}
+
+void reset_pid_q15(pid_q15 *pid, float kp, float ki, float kd, float dt, int16_t out_min, int16_t out_max)
+{
+    pid->shift = pid_shift(kp, ki * dt, kd / dt, 15);
+
+    float scale = 32768.0f / (float)(1 << pid->shift);
+    pid->kp = saturate_q15(lroundf(kp * scale));
+    pid->ki_dt = saturate_q15(lroundf(ki * dt * scale));
+    pid->kd_dt = saturate_q15(lroundf(kd / dt * scale));
+
+    pid->out_min = out_min;
+    pid->out_max = out_max;
+    pid->integral_min = (int32_t)out_min * (1 << (15 - pid->shift));
+    pid->integral_max = (int32_t)out_max * (1 << (15 - pid->shift));
+    pid->integral = 0;
+    pid->pre_error = 0;
+    pid->out = 0;
+    pid->isSaturation = false;
+}
+
+int16_t output_pid_q15(pid_q15 *pid, int16_t error)
+{
+    uint8_t n = 15 - pid->shift;
+    int16_t d_error = saturate_q15((int32_t)error - pid->pre_error);
+
+    // every product fits 31 bits, integral stays inside the output range
+    if (!pid->isSaturation)
+    {
+        int32_t integral = pid->integral + (int32_t)pid->ki_dt * error;
+        if (integral > pid->integral_max) integral = pid->integral_max;
+        if (integral < pid->integral_min) integral = pid->integral_min;
+        pid->integral = integral;
+    }
+
+    int64_t acc = (int64_t)((int32_t)pid->kp * error) + pid->integral + (int32_t)pid->kd_dt * d_error;
+    if (n) acc += 1 << (n - 1);
+    int32_t raw = saturate_q31(acc >> n);
+
+    int16_t out = pid->out_max;
+    if (raw < pid->out_max) out = (raw > pid->out_min) ? (int16_t)raw : pid->out_min;
+
+    pid->isSaturation = (raw != out) && ((raw > 0) == (error > 0)) && error != 0;
+    pid->pre_error = error;
+    pid->out = out;
+    return out;
+}
+
+void reset_pid_q31(pid_q31 *pid, float kp, float ki, float kd, float dt, int32_t out_min, int32_t out_max)
+{
+    pid->shift = pid_shift(kp, ki * dt, kd / dt, 31);
+
+    double scale = 2147483648.0 / (double)(1ull << pid->shift);
+    pid->kp = saturate_q31(llround((double)kp * scale));
+    pid->ki_dt = saturate_q31(llround((double)ki * dt * scale));
+    pid->kd_dt = saturate_q31(llround((double)kd / dt * scale));
+
+    pid->out_min = out_min;
+    pid->out_max = out_max;
+    pid->integral_min = (int64_t)out_min * (int64_t)(1ull << (31 - pid->shift));
+    pid->integral_max = (int64_t)out_max * (int64_t)(1ull << (31 - pid->shift));
+    pid->integral = 0;
+    pid->pre_error = 0;
+    pid->out = 0;
+    pid->isSaturation = false;
+}
+
+int32_t output_pid_q31(pid_q31 *pid, int32_t error)
+{
+    uint8_t n = 31 - pid->shift;
+    int32_t d_error = saturate_q31((int64_t)error - pid->pre_error);
+
+    // products fit 63 bits, integral stays inside the output range so the sum can not wrap
+    if (!pid->isSaturation)
+    {
+        int64_t integral = pid->integral + (int64_t)pid->ki_dt * error;
+        if (integral > pid->integral_max) integral = pid->integral_max;
+        if (integral < pid->integral_min) integral = pid->integral_min;
+        pid->integral = integral;
+    }
+
+    // terms are scaled down one by one, their sum at full scale would need 65 bits
+    int64_t round = n ? (1ll << (n - 1)) : 0;
+    int64_t raw = (((int64_t)pid->kp * error + round) >> n)
+                + ((pid->integral + round) >> n)
+                + (((int64_t)pid->kd_dt * d_error + round) >> n);
+
+    int32_t out = pid->out_max;
+    if (raw < pid->out_max) out = (raw > pid->out_min) ? (int32_t)raw : pid->out_min;
+
+    pid->isSaturation = (raw != out) && ((raw > 0) == (error > 0)) && error != 0;
+    pid->pre_error = error;
+    pid->out = out;
+    return out;
+}
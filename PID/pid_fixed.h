@@ -0,0 +1,88 @@
+#ifndef PID_FIXED_H_
+#define PID_FIXED_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+  Fixed point PID in Q15 and Q31 (no float, no divide per update, bit exact on host and target)
+  Gains come from float Kp, Ki, Kd and dt once at reset: Ki * dt and Kd / dt are precomputed
+  Gains share one exponent: real gain = gain * 2^shift, so gains above 1 are allowed
+
+  Overflow policy: every sum saturates, error difference saturates to the input width,
+  output saturates to [out_min, out_max]
+  Anti windup is the one of output_PID: integral is clamped (to the output range) and
+  stops integrating while the output is saturated in the direction of the error
+
+  Example (current loop at 20kHz, error and output in ADC / PWM counts):
+      pid_q15 current;
+      reset_pid_q15(&current, 0.8f, 1500.0f, 0.0f, 1.0f / 20000, -1000, 1000);
+      int16_t duty = output_pid_q15(&current, target - measured);
+*/
+
+typedef struct
+{
+    int16_t kp;             // Q15 << shift
+    int16_t ki_dt;          // Q15 << shift, Ki * dt
+    int16_t kd_dt;          // Q15 << shift, Kd / dt
+    uint8_t shift;
+    int16_t out_min;
+    int16_t out_max;
+    int32_t integral;       // sum of ki_dt * error (Q30 >> shift)
+    int32_t integral_min;   // out_min in integral units
+    int32_t integral_max;
+    int16_t pre_error;
+    int16_t out;
+    bool isSaturation;
+} pid_q15;
+
+typedef struct
+{
+    int32_t kp;             // Q31 << shift
+    int32_t ki_dt;          // Q31 << shift, Ki * dt
+    int32_t kd_dt;          // Q31 << shift, Kd / dt
+    uint8_t shift;
+    int32_t out_min;
+    int32_t out_max;
+    int64_t integral;       // sum of ki_dt * error (Q62 >> shift)
+    int64_t integral_min;
+    int64_t integral_max;
+    int32_t pre_error;
+    int32_t out;
+    bool isSaturation;
+} pid_q31;
+
+/**
+  * @brief  reset state and set gains of Q15 PID
+  * @param  *pid is pointer to the PID structure
+  * @param  kp, ki, kd are gains in output units per error unit (per second for ki, second for kd)
+  * @param  dt is sampling time in s
+  * @param  out_min, out_max is output range (also the integral range)
+  * @note   gains are rounded to 16 bits with one common exponent, a gain far
+  *         smaller than the largest one loses resolution (check pid->ki_dt != 0)
+*/
+void reset_pid_q15(pid_q15 *pid, float kp, float ki, float kd, float dt, int16_t out_min, int16_t out_max);
+
+/**
+  * @brief  update Q15 PID
+  * @param  *pid is pointer to the PID structure
+  * @param  error is setpoint - measurement
+  * @return output, also in pid->out
+*/
+int16_t output_pid_q15(pid_q15 *pid, int16_t error);
+
+/**
+  * @brief  reset state and set gains of Q31 PID (see reset_pid_q15)
+*/
+void reset_pid_q31(pid_q31 *pid, float kp, float ki, float kd, float dt, int32_t out_min, int32_t out_max);
+
+/**
+  * @brief  update Q31 PID
+  * @param  *pid is pointer to the PID structure
+  * @param  error is setpoint - measurement
+  * @return output, also in pid->out
+*/
+int32_t output_pid_q31(pid_q31 *pid, int32_t error);
+
+#endif
+/*PID_FIXED_H_*/
@@ -0,0 +1,104 @@
+#include "pid_schedule.h"
+#include <math.h>
+
+void reset_gain_schedule(gain_schedule *schedule)
+{
+    schedule->points = 0;
+    schedule->uniform = false;
+    schedule->inv_step = 0;
+}
+
+bool add_gain_point(gain_schedule *schedule, float x, float p, float i, float d)
+{
+    uint8_t n = schedule->points;
+
+    if (n >= GAIN_SCHEDULE_MAX_POINTS) return false;
+    if (n && x <= schedule->x[n - 1]) return false;
+
+    schedule->x[n] = x;
+    schedule->p[n] = p;
+    schedule->i[n] = i;
+    schedule->d[n] = d;
+    schedule->points = ++n;
+
+    // equal spacing (to 0.1% of the step) allows the O(1) lookup
+    if (n < 2) return true;
+    float step = schedule->x[1] - schedule->x[0];
+    schedule->uniform = fabsf((x - schedule->x[n - 2]) - step) <= step * 1e-3f && (n == 2 || schedule->uniform);
+    schedule->inv_step = 1.0f / step;
+    return true;
+}
+
+// index of the segment [x[k], x[k + 1]] holding x, x inside the table
+static uint8_t find_segment(const gain_schedule *schedule, float x)
+{
+    uint8_t last = schedule->points - 2;
+
+    if (schedule->uniform)
+    {
+        uint8_t k = (uint8_t)((x - schedule->x[0]) * schedule->inv_step);
+        return (k > last) ? last : k;
+    }
+
+    uint8_t low = 0, high = last;
+    while (low < high)
+    {
+        uint8_t mid = (low + high + 1) / 2;
+        if (schedule->x[mid] <= x) low = mid;
+        else high = mid - 1;
+    }
+    return low;
+}
+
+void schedule_PID_gain(const gain_schedule *schedule, PID_instance *PID, float x)
+{
+    float p, i, d;
+    uint8_t n = schedule->points;
+
+    if (n == 0) return;
+    if (n == 1 || x <= schedule->x[0])
+    {
+        p = schedule->p[0];
+        i = schedule->i[0];
+        d = schedule->d[0];
+    }
+    else if (x >= schedule->x[n - 1])
+    {
+        p = schedule->p[n - 1];
+        i = schedule->i[n - 1];
+        d = schedule->d[n - 1];
+    }
+    else
+    {
+        uint8_t k = find_segment(schedule, x);
+        float t = (x - schedule->x[k]) / (schedule->x[k + 1] - schedule->x[k]);
+        p = schedule->p[k] + t * (schedule->p[k + 1] - schedule->p[k]);
+        i = schedule->i[k] + t * (schedule->i[k + 1] - schedule->i[k]);
+        d = schedule->d[k] + t * (schedule->d[k + 1] - schedule->d[k]);
+    }
+
+    // bumpless: keep the I term, integral_gain * integral, across the change
+    // i == 0 has no I term, the integral stays scaled for integral_gain (output_PID holds it)
+    if (PID->integral_gain == 0.0f) PID->integral_gain = PID->i_gain;
+    float scaled = PID->integral_gain;
+    if (scaled == 0.0f)
+    {
+        PID->integral_gain = i;     // nothing integrated yet
+    }
+    else if (i != 0.0f && fabsf(i - scaled) > GAIN_SCHEDULE_I_EPSILON * fabsf(scaled))
+    {
+        float ratio = scaled / i;
+        float integral = PID->integral_error * ratio;
+        float integral_time = PID->integral_time * ratio;
+
+        // near i = 0 the I term does not fit the integral: keep the last scale, the I term
+        // then fades with i and is back in full when i is back
+        if (fabsf(integral) <= MAX_INTEGRAL && fabsf(integral_time) <= MAX_INTEGRAL / 1000.0f)
+        {
+            PID->integral_error = lroundf(integral);
+            PID->integral_time = integral_time;
+            PID->integral_gain = i;
+        }
+    }
+    set_PID_gain(PID, p, i, d);
+}
@@ -0,0 +1,71 @@
+#ifndef PID_SCHEDULE_H_
+#define PID_SCHEDULE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "PID.h"
+
+/*
+  Gain scheduling for PID_instance: a table of breakpoints of one scheduling variable
+  (speed, battery voltage, ...) with gains, linearly interpolated between breakpoints
+  and held outside the table.
+  Lookup is O(1) when the breakpoints are equally spaced (detected when they are added),
+  else a binary search (O(log n)).
+  Changing gains is bumpless: the integral is rescaled so the I term stays the same when
+  i_gain changes (integral_error of output_PID and integral_time of output_PID_dt).
+  The rescale is against the gain the integral was last scaled for and only when i_gain moved
+  more than GAIN_SCHEDULE_I_EPSILON from it, so small steps every tick neither round nor drift.
+  Where i is 0 there is no I term: the integral is held (not integrated) and the I term it
+  had comes back when i leaves 0.
+
+  Example (speed loop scheduled on the measured RPM):
+      gain_schedule schedule;
+      reset_gain_schedule(&schedule);
+      add_gain_point(&schedule,   0.0f, 3.0f, 1.0f, 0.02f);
+      add_gain_point(&schedule, 100.0f, 2.0f, 0.6f, 0.01f);
+      add_gain_point(&schedule, 200.0f, 1.2f, 0.4f, 0.01f);
+
+      // throw into HAL_TIM_PeriodElapsedCallback, before output_PID
+      schedule_PID_gain(&schedule, &pid, abs(enc._RPM));
+*/
+
+/* User Configurations */
+#define GAIN_SCHEDULE_MAX_POINTS 8
+#define GAIN_SCHEDULE_I_EPSILON  1e-3f   // relative change of i_gain which rescales the integral
+/* End User Configurations */
+
+typedef struct
+{
+    float x[GAIN_SCHEDULE_MAX_POINTS];     // breakpoints, increasing
+    float p[GAIN_SCHEDULE_MAX_POINTS];
+    float i[GAIN_SCHEDULE_MAX_POINTS];
+    float d[GAIN_SCHEDULE_MAX_POINTS];
+    uint8_t points;
+    bool uniform;                          // equal spacing, segment = (x - x[0]) * inv_step
+    float inv_step;
+} gain_schedule;
+
+/**
+  * @brief  clear the table
+  * @param  *schedule is pointer to the gain schedule structure
+*/
+void reset_gain_schedule(gain_schedule *schedule);
+
+/**
+  * @brief  add one breakpoint at the end of the table
+  * @param  x is value of the scheduling variable, larger than the previous breakpoint
+  * @param  p, i, d are gains at x (as set_PID_gain)
+  * @return false if the table is full or x does not increase
+*/
+bool add_gain_point(gain_schedule *schedule, float x, float p, float i, float d);
+
+/**
+  * @brief  set interpolated gains of the PID for the scheduling variable x
+  * @param  *PID is pointer to the PID structure
+  * @param  x is scheduling variable now
+  * @note   the integral is rescaled when i_gain changes (bumpless), held while i is 0
+*/
+void schedule_PID_gain(const gain_schedule *schedule, PID_instance *PID, float x);
+
+#endif
+/*PID_SCHEDULE_H_*/
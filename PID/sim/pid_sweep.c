@@ -0,0 +1,257 @@
+/*
+ * pid_sweep.c
+ *
+ *  Closed loop regression and gain sweep of PID.c on the host plant models
+ *  1. step response of output_PID on every plant with reference gains
+ *  2. grid sweep of p/i/d gains on the DC motor, best IAE under an overshoot limit
+ *  3. relay auto tuning (pid_autotune) on the FOPDT plant, then its step response
+ *  4. double integrator: step against an S curve move with acceleration feed forward
+ *  5. +-5 ms jitter of the control tick: fixed step (updateEncoder, output_PID) against
+ *     measured step (updateEncoder_dt, output_PID_dt), steady speed error on the DC motor
+ *  6. position -> velocity cascade (pid_cascade) on the DC motor, step of 5000 pulses
+ *
+ *  Build and run (from the repository root):
+ *    gcc -O2 -D PLATFORM_SIM -I Platform/sim PID/sim/plant_sim.c PID/sim/pid_sweep.c \
+ *        PID/PID.c PID/pid_autotune.c PID/pid_fixed.c PID/pid_cascade.c MotionProfile/motion_profile.c Encoder/Encoder.c "PWM control/PWMcontrol.c" \
+ *        "AVERAGE FILTER/average_filter.c" Platform/sim/platform_sim.c -lm -o pid_sweep
+ *    ./pid_sweep
+ */
+
+#include <stdio.h>
+#include "plant_sim.h"
+#include "../pid_autotune.h"
+#include "../pid_cascade.h"
+#include "../../MotionProfile/motion_profile.h"
+
+#define SWEEP_OVERSHOOT 5.0f    // % allowed in the sweep
+
+typedef struct
+{
+    const char *name;
+    plant_type type;
+    int16_t target;
+    float p, i, d;
+} reference_case;
+
+static void print_result(const char *name, float p, float i, float d, const plant_sim_result *result)
+{
+    printf("%-18s %6.2f %6.2f %6.3f | %7.3f %6.1f%% %7.3f %9.2f %8.1f | %6.1f\n",
+           name, p, i, d,
+           result->rise_time, result->overshoot, result->settling_time, result->iae, result->final_value,
+           result->controller_ns);
+}
+
+static void run_pid(const plant_config *config, float p, float i, float d, int16_t target, float duration_s, plant_sim_result *result)
+{
+    PID_instance pid;
+
+    reset_PID_gain(&pid);
+    set_PID_gain(&pid, p, i, d);
+    pid.integral_error = 0;
+    pid.output_PID = 0;
+    plant_sim_run(config, plant_sim_output_PID, &pid, target, duration_s, result);
+}
+
+static void reference_runs(void)
+{
+    static const reference_case cases[] =
+    {
+        {"dc_motor 100rpm",  PLANT_DC_MOTOR,          100, 4.0f, 20.0f, 0.0f},
+        {"fopdt 100rpm",     PLANT_FOPDT,             100, 2.0f, 10.0f, 0.0f},
+        {"double_int 2000p", PLANT_DOUBLE_INTEGRATOR, 2000, 0.3f, 0.0f, 0.6f},
+    };
+    plant_config config;
+    plant_sim_result result;
+
+    printf("case                  kp     ki     kd   |  rise s  overs  settle s       IAE    final | ctrl ns\n");
+    for (uint32_t k = 0; k < sizeof(cases) / sizeof(cases[0]); k++)
+    {
+        plant_sim_default(&config, cases[k].type);
+        run_pid(&config, cases[k].p, cases[k].i, cases[k].d, cases[k].target, 5.0f, &result);
+        print_result(cases[k].name, cases[k].p, cases[k].i, cases[k].d, &result);
+    }
+}
+
+static void sweep(void)
+{
+    static const float p_gain[] = {0.5f, 1.0f, 2.0f, 3.0f, 4.0f, 6.0f, 8.0f, 12.0f};
+    static const float i_gain[] = {0.0f, 2.0f, 5.0f, 10.0f, 20.0f, 40.0f, 80.0f, 160.0f};
+    static const float d_gain[] = {0.0f, 0.01f, 0.03f, 0.1f};
+    plant_config config;
+    plant_sim_result result, best = {0};
+    float best_p = 0, best_i = 0, best_d = 0, run_us = 0;
+    uint32_t runs = 0;
+
+    plant_sim_default(&config, PLANT_DC_MOTOR);
+    best.iae = -1;
+    for (uint8_t a = 0; a < sizeof(p_gain) / sizeof(p_gain[0]); a++)
+    {
+        for (uint8_t b = 0; b < sizeof(i_gain) / sizeof(i_gain[0]); b++)
+        {
+            for (uint8_t c = 0; c < sizeof(d_gain) / sizeof(d_gain[0]); c++)
+            {
+                run_pid(&config, p_gain[a], i_gain[b], d_gain[c], 100, 3.0f, &result);
+                run_us += result.run_us;
+                runs++;
+                if (result.overshoot > SWEEP_OVERSHOOT || result.rise_time < 0) continue;
+                if (best.iae < 0 || result.iae < best.iae)
+                {
+                    best = result;
+                    best_p = p_gain[a];
+                    best_i = i_gain[b];
+                    best_d = d_gain[c];
+                }
+            }
+        }
+    }
+
+    printf("\nsweep dc_motor 100rpm: %u gain sets, %.0f runs/s (3 s simulated each)\n", runs, runs / (run_us / 1e6f));
+    if (best.iae < 0) printf("no gain set under %.0f%% overshoot\n", SWEEP_OVERSHOOT);
+    else print_result("best IAE", best_p, best_i, best_d, &best);
+}
+
+static int16_t relay_controller(void *context, int16_t target, int16_t measurement)
+{
+    UNUSED(target);
+    return update_autotune(context, measurement);
+}
+
+static void autotune(void)
+{
+    plant_config config;
+    plant_sim_result result;
+    pid_autotune tuner;
+    PID_instance pid;
+
+    plant_sim_default(&config, PLANT_FOPDT);
+    start_autotune(&tuner, 100, 500, 300, 2, 1000 / TIME_SAMPLING, 60);
+    plant_sim_run(&config, relay_controller, &tuner, 100, 60.0f, &result);
+    if (tuner.state != AUTOTUNE_DONE)
+    {
+        printf("\nautotune fopdt: failed\n");
+        return;
+    }
+    printf("\nautotune fopdt: Ku %.2f Tu %.3f s\n", tuner.ku, tuner.tu);
+
+    reset_PID_gain(&pid);
+    apply_autotune(&tuner, &pid, AUTOTUNE_TYREUS_LUYBEN);
+    plant_sim_run(&config, plant_sim_output_PID, &pid, 100, 5.0f, &result);
+    print_result("tyreus-luyben", pid.p_gain, pid.i_gain, pid.d_gain, &result);
+}
+
+typedef struct
+{
+    motion_profile move;
+    PID_instance pid;
+    float ka;
+} profiled_move;
+
+static int16_t profile_controller(void *context, int16_t target, int16_t measurement)
+{
+    profiled_move *m = context;
+    UNUSED(target);
+    update_motion(&m->move);
+    output_PID_2dof(&m->pid, (int16_t)m->move.pos, measurement, motion_feed_forward(&m->move, 0.0f, m->ka), 1000 / TIME_SAMPLING);
+    return m->pid.output_PID;
+}
+
+static void profile(void)
+{
+    plant_config config;
+    plant_sim_result result;
+    profiled_move m;
+
+    plant_sim_default(&config, PLANT_DOUBLE_INTEGRATOR);
+    printf("\nmove 2000 pulses on double_int\n");
+    run_pid(&config, 0.3f, 0.0f, 0.6f, 2000, 5.0f, &result);
+    print_result("step", 0.3f, 0.0f, 0.6f, &result);
+
+    // plant gives gain * PULSE_PER_REVOLUTION pulses/s^2 at full PWM
+    m.ka = MAX_PULSE_WIDTH / (config.gain * PULSE_PER_REVOLUTION);
+    set_motion_limits(&m.move, PROFILE_SCURVE, 1500.0f, 1000.0f, 4000.0f, TIME_SAMPLING / 1000.0f);
+    start_motion(&m.move, 0, 2000);
+    reset_PID_gain(&m.pid);
+    set_PID_gain(&m.pid, 0.3f, 0.0f, 0.6f);
+    set_PID_weight(&m.pid, 1.0f, 1.0f);
+    m.pid.integral_error = 0;
+    m.pid.output_PID = 0;
+    plant_sim_run(&config, profile_controller, &m, 2000, 5.0f, &result);
+    print_result("s-curve + ff", 0.3f, 0.0f, 0.6f, &result);
+    printf("(profile lasts %.2f s)\n", motion_duration(&m.move));
+}
+
+static void jitter(void)
+{
+    plant_config config;
+    plant_sim_result result;
+    plant_sim_pid_dt pid_dt;
+
+    plant_sim_default(&config, PLANT_DC_MOTOR);
+    printf("\ndc_motor 100rpm, tick %u ms                      steady error rpm\n", TIME_SAMPLING);
+
+    run_pid(&config, 4.0f, 20.0f, 0.0f, 100, 10.0f, &result);
+    printf("%-44s %8.2f\n", "no jitter, fixed step", result.steady_error);
+
+    config.jitter_us = 5000;
+    run_pid(&config, 4.0f, 20.0f, 0.0f, 100, 10.0f, &result);
+    printf("%-44s %8.2f\n", "+-5 ms, fixed step (output_PID)", result.steady_error);
+
+    config.measured_dt = true;
+    reset_PID_gain(&pid_dt.pid);
+    set_PID_gain(&pid_dt.pid, 4.0f, 20.0f, 0.0f);
+    pid_dt.pid.output_PID = 0;
+    pid_dt.pre_time_us = platform_micros();
+    plant_sim_run(&config, plant_sim_output_PID_dt, &pid_dt, 100, 10.0f, &result);
+    printf("%-44s %8.2f\n", "+-5 ms, measured step (output_PID_dt)", result.steady_error);
+}
+
+typedef struct
+{
+    pid_cascade axis;
+    int16_t pre_position;
+} cascade_axis;
+
+// velocity from the position difference of one tick, no current sensor: velocity drives the PWM
+static int16_t cascade_controller(void *context, int16_t target, int16_t measurement)
+{
+    cascade_axis *c = context;
+    int32_t measured[PID_CASCADE_STAGES] = {0};
+
+    UNUSED(target);
+    measured[PID_CASCADE_POSITION] = measurement;
+    measured[PID_CASCADE_VELOCITY] = (int32_t)(int16_t)(measurement - c->pre_position) * 1000 / TIME_SAMPLING;
+    c->pre_position = measurement;
+    return (int16_t)pid_cascade_update(&c->axis, measured);
+}
+
+static void cascade(void)
+{
+    plant_config config;
+    plant_sim_result result;
+    cascade_axis c = {0};
+
+    plant_sim_default(&config, PLANT_DC_MOTOR);
+    config.position_output = true;
+
+    // position every 2 ticks (pulses -> pulses/s, max 3000), velocity every tick (pulses/s -> PWM)
+    reset_pid_cascade(&c.axis, TIME_SAMPLING / 1000.0f);
+    set_pid_cascade_stage(&c.axis, PID_CASCADE_POSITION, 2, 3.0f, 0.0f, 0.0f, -3000, 3000);
+    set_pid_cascade_stage(&c.axis, PID_CASCADE_VELOCITY, 1, 0.3f, 1.0f, 0.0f, -MAX_PID_VALUE, MAX_PID_VALUE);
+    set_pid_cascade_target(&c.axis, 5000);
+    plant_sim_run(&config, cascade_controller, &c, 5000, 5.0f, &result);
+
+    printf("\ncascade dc_motor 5000 pulses, position kp 3 -> velocity\n");
+    print_result("velocity stage", 0.3f, 1.0f, 0.0f, &result);
+}
+
+int main(void)
+{
+    platform_sim_init();
+    reference_runs();
+    sweep();
+    autotune();
+    profile();
+    jitter();
+    cascade();
+    return 0;
+}
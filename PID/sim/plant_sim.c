@@ -0,0 +1,219 @@
+/*
+ * plant_sim.c
+ *
+ *  Plant models and the closed loop harness of plant_sim.h
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "plant_sim.h"
+
+#define PLANT_SIM_PI 3.14159265f
+
+static platform_timer sim_encoder_timer;
+static platform_timer sim_motor_timer;
+
+static uint64_t host_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+void plant_sim_default(plant_config *config, plant_type type)
+{
+    memset(config, 0, sizeof(plant_config));
+    config->type = type;
+    switch (type)
+    {
+    case PLANT_DC_MOTOR:
+        // no load speed 12V / ke = 21 rad/s (200 RPM), electrical 1 ms, mechanical about 10 ms
+        config->supply_v = 12.0f;
+        config->resistance = 3.0f;
+        config->inductance = 0.003f;
+        config->ke = 0.55f;
+        config->inertia = 0.001f;
+        config->friction = 0.0005f;
+        break;
+    case PLANT_FOPDT:
+        config->gain = MAX_RPM;
+        config->tau = 0.1f;
+        config->dead_time = 0.03f;
+        break;
+    case PLANT_DOUBLE_INTEGRATOR:
+        config->gain = 2.0f;
+        break;
+    }
+}
+
+void plant_init(plant *p, const plant_config *config)
+{
+    memset(p, 0, sizeof(plant));
+    p->config = *config;
+    float steps = config->dead_time * 1000000.0f / PLANT_SIM_STEP_US;
+    p->delay_length = (steps >= PLANT_SIM_MAX_DELAY) ? PLANT_SIM_MAX_DELAY - 1 : (uint16_t)steps;
+}
+
+float plant_update(plant *p, float duty, float dt)
+{
+    const plant_config *c = &p->config;
+
+    if (duty > 1.0f) duty = 1.0f;
+    if (duty < -1.0f) duty = -1.0f;
+
+    switch (c->type)
+    {
+    case PLANT_DC_MOTOR:
+    {
+        float current = p->state[0];
+        float speed = p->state[1];
+        p->state[0] += dt * (c->supply_v * duty - c->resistance * current - c->ke * speed) / c->inductance;
+        p->state[1] += dt * (c->ke * current - c->friction * speed - c->load) / c->inertia;
+        return p->state[1] * 60.0f / (2.0f * PLANT_SIM_PI);
+    }
+    case PLANT_FOPDT:
+    {
+        float delayed = duty;
+        if (p->delay_length)
+        {
+            delayed = p->delay[p->delay_index];
+            p->delay[p->delay_index] = duty;
+            p->delay_index = (p->delay_index + 1) % p->delay_length;
+        }
+        p->state[0] += dt / c->tau * (c->gain * delayed - p->state[0]);
+        return p->state[0];
+    }
+    case PLANT_DOUBLE_INTEGRATOR:
+        p->state[1] += c->gain * duty * dt;
+        p->state[0] += p->state[1] * dt;
+        return p->state[0];
+    }
+    return 0.0f;
+}
+
+int16_t plant_sim_output_PID(void *context, int16_t target, int16_t measurement)
+{
+    PID_instance *pid = context;
+    output_PID(pid, target - measurement, 1000 / TIME_SAMPLING);
+    return pid->output_PID;
+}
+
+int16_t plant_sim_output_PID_dt(void *context, int16_t target, int16_t measurement)
+{
+    plant_sim_pid_dt *controller = context;
+    uint32_t now_us = platform_micros();
+
+    output_PID_dt(&controller->pid, target - measurement, now_us - controller->pre_time_us);
+    controller->pre_time_us = now_us;
+    return controller->pid.output_PID;
+}
+
+// period of the next control tick in plant steps
+static uint32_t tick_steps(const plant_config *config, uint32_t *seed)
+{
+    int32_t period_us = TIME_SAMPLING * 1000;
+
+    if (config->jitter_us)
+    {
+        *seed = *seed * 1664525u + 1013904223u;
+        period_us += (int32_t)((*seed >> 8) % (2u * config->jitter_us + 1)) - config->jitter_us;
+    }
+    return (period_us + PLANT_SIM_STEP_US / 2) / PLANT_SIM_STEP_US;
+}
+
+void plant_sim_run(const plant_config *config, plant_sim_controller controller, void *context,
+                   int16_t target, float duration_s, plant_sim_result *result)
+{
+    static plant p;
+    Encoder enc;
+    PWMcontrol motor;
+    bool position_loop = config->type == PLANT_DOUBLE_INTEGRATOR || config->position_output;
+    uint32_t total_steps = (uint32_t)(duration_s * 1000000.0f / PLANT_SIM_STEP_US);
+    uint32_t elapsed_steps = 0;
+    uint32_t ticks = 0;
+    uint32_t seed = 12345;
+    uint32_t steady_steps = 0;
+    float dt = PLANT_SIM_STEP_US / 1000000.0f;
+    double pulses = 0;          // exact encoder position, the timer gets the whole pulses
+    int64_t moved = 0;
+    int32_t position = 0;       // pulses counted by the firmware
+    uint64_t controller_ns = 0;
+    uint64_t run_start = host_ns();
+
+    memset(&sim_encoder_timer, 0, sizeof(platform_timer));
+    memset(&sim_motor_timer, 0, sizeof(platform_timer));
+    plant_init(&p, config);
+    Encoder_Init(&enc, &sim_encoder_timer);
+    Motor_Init(&motor, &sim_motor_timer, TIM_CHANNEL_1, TIM_CHANNEL_2);
+
+    memset(result, 0, sizeof(plant_sim_result));
+    result->rise_time = -1.0f;
+    float rise_start = -1.0f;
+    float peak = 0.0f;
+    float y = 0.0f;
+
+    while (elapsed_steps < total_steps)
+    {
+        // firmware side, as in HAL_TIM_PeriodElapsedCallback
+        uint64_t start = host_ns();
+        int32_t diffPulse;
+        updateDiffPulse(&enc, &diffPulse);
+        position += diffPulse;
+        if (config->measured_dt) updateEncoder_dt(&enc, false, platform_micros());
+        else updateEncoder(&enc, false);
+        int16_t measurement = position_loop ? (int16_t)position : (int16_t)enc._RPM;
+        int16_t out = controller(context, target, measurement);
+        set_motor(&motor, out >= 0 ? FORWARD : BACKWARD, abs(out));
+        controller_ns += host_ns() - start;
+
+        // BACKWARD drives channel 1, FORWARD channel 2
+        float duty = ((float)sim_motor_timer.compare[1] - (float)sim_motor_timer.compare[0]) / MAX_PULSE_WIDTH;
+        uint32_t steps = tick_steps(config, &seed);
+
+        for (uint32_t s = 0; s < steps; s++)
+        {
+            float output = plant_update(&p, duty, dt);
+
+            if (config->type == PLANT_DOUBLE_INTEGRATOR)
+            {
+                pulses = (double)output * PULSE_PER_REVOLUTION;
+            }
+            else
+            {
+                pulses += (double)output / 60.0 * PULSE_PER_REVOLUTION * dt;
+            }
+
+            // metrics on the true plant output, in the unit of target
+            y = position_loop ? (float)pulses : output;
+            float t = (elapsed_steps + s + 1) * dt;
+            float ratio = target ? y / target : 0.0f;
+            result->iae += fabsf(target - y) * dt;
+            if (elapsed_steps + s >= total_steps / 2)
+            {
+                result->steady_error += fabsf(target - y);
+                steady_steps++;
+            }
+            if (ratio > peak) peak = ratio;
+            if (rise_start < 0 && ratio >= 0.1f) rise_start = t;
+            if (result->rise_time < 0 && ratio >= 0.9f) result->rise_time = t - rise_start;
+            if (fabsf(ratio - 1.0f) > 0.02f) result->settling_time = t;
+        }
+
+        // the firmware only reads the counter at the next tick
+        int64_t whole = (int64_t)floor(pulses);
+        platform_sim_encoder_move(&sim_encoder_timer, (int32_t)(whole - moved));
+        moved = whole;
+        platform_sim_advance_ns((uint64_t)steps * PLANT_SIM_STEP_US * 1000);
+        elapsed_steps += steps;
+        ticks++;
+    }
+
+    if (steady_steps) result->steady_error /= steady_steps;
+
+    result->overshoot = (peak > 1.0f) ? (peak - 1.0f) * 100.0f : 0.0f;
+    result->final_value = y;
+    result->controller_ns = ticks ? (float)controller_ns / ticks : 0.0f;
+    result->run_us = (host_ns() - run_start) / 1000.0f;
+}
@@ -0,0 +1,129 @@
+/*
+ * plant_sim.h
+ *
+ *  Host closed loop simulation for PID regression tests and gain sweeps
+ *  Plant models: DC motor (electrical + mechanical), first order plus dead time,
+ *  double integrator. The loop runs the firmware code path every TIME_SAMPLING:
+ *  plant -> encoder pulses (quantized, platform sim timer) -> updateEncoder ->
+ *  controller (output_PID or any other) -> set_motor -> PWM compare (saturates at
+ *  MAX_PULSE_WIDTH) -> plant.
+ *  Speed plants are controlled in RPM (enc._RPM), the double integrator in encoder pulses
+ *  (speed plants too with position_output, e.g. a position cascade on the DC motor).
+ *  The control tick can jitter around TIME_SAMPLING (jitter_us), simulated time then moves
+ *  by the real tick so updateEncoder_dt / output_PID_dt see it through platform_micros.
+ */
+
+#ifndef SIM_PLANT_SIM_H_
+#define SIM_PLANT_SIM_H_
+
+#include "../../Platform/sim/platform_sim.h"
+#include "../../Encoder/encoder.h"
+
+/* User Configurations */
+#define PLANT_SIM_STEP_US   100     // plant integration step (below L / R of the motor)
+#define PLANT_SIM_MAX_DELAY 8192    // dead time steps (0.8 s at 100 us)
+/* End User Configurations */
+
+typedef enum
+{
+    PLANT_DC_MOTOR = 0,
+    PLANT_FOPDT,
+    PLANT_DOUBLE_INTEGRATOR
+} plant_type;
+
+typedef struct
+{
+    plant_type type;
+    // DC motor, at the output shaft (gearbox included)
+    float supply_v;
+    float resistance;       // ohm
+    float inductance;       // H
+    float ke;               // back EMF V*s/rad, also torque constant N*m/A
+    float inertia;          // kg*m^2
+    float friction;         // N*m*s/rad
+    float load;             // N*m, constant load torque
+    // FOPDT: RPM at full duty, double integrator: rev/s^2 at full duty
+    float gain;
+    float tau;              // s, FOPDT time constant
+    float dead_time;        // s, FOPDT dead time
+    // control tick
+    uint16_t jitter_us;     // each tick is TIME_SAMPLING +- up to jitter_us (uniform, same sequence every run)
+    bool measured_dt;       // updateEncoder_dt(platform_micros()) instead of updateEncoder
+    bool position_output;   // speed plants: measurement, target and metrics in encoder pulses
+} plant_config;
+
+typedef struct
+{
+    plant_config config;
+    float state[2];         // DC motor: current, speed rad/s; FOPDT: RPM; double integrator: rev, rev/s
+    float delay[PLANT_SIM_MAX_DELAY];
+    uint16_t delay_length;
+    uint16_t delay_index;
+} plant;
+
+typedef struct
+{
+    float rise_time;        // s, 10% to 90% of target (-1 if never reached)
+    float overshoot;        // % of target
+    float settling_time;    // s, last time outside +-2% of target
+    float iae;              // integral of |target - output|, unit * s
+    float steady_error;     // mean of |target - output| over the second half of the run
+    float final_value;      // plant output at the end (RPM or pulses)
+    float controller_ns;    // host time of one control tick (updateEncoder, controller, set_motor)
+    float run_us;           // host time of the whole run
+} plant_sim_result;
+
+/**
+  * @brief  controller called every TIME_SAMPLING
+  * @param  *context is the pointer given to plant_sim_run
+  * @param  target, measurement in RPM (speed plants) or pulses (double integrator)
+  * @return PWM command, sign is direction (as PID_instance.output_PID)
+*/
+typedef int16_t (*plant_sim_controller)(void *context, int16_t target, int16_t measurement);
+
+/**
+  * @brief  parameters of a small 12V gear motor close to MAX_RPM / PULSE_PER_REVOLUTION
+*/
+void plant_sim_default(plant_config *config, plant_type type);
+
+/**
+  * @brief  reset plant state
+*/
+void plant_init(plant *p, const plant_config *config);
+
+/**
+  * @brief  integrate the plant over dt
+  * @param  duty is -1..1
+  * @param  dt is time step in s
+  * @return output: RPM (DC motor, FOPDT) or revolutions (double integrator)
+*/
+float plant_update(plant *p, float duty, float dt);
+
+/**
+  * @brief  output_PID as a plant_sim_controller, context is the PID_instance
+*/
+int16_t plant_sim_output_PID(void *context, int16_t target, int16_t measurement);
+
+typedef struct
+{
+    PID_instance pid;
+    uint32_t pre_time_us;   // platform_micros of the previous tick
+} plant_sim_pid_dt;
+
+/**
+  * @brief  output_PID_dt as a plant_sim_controller, context is a plant_sim_pid_dt
+  *         dt is measured with platform_micros as on target
+*/
+int16_t plant_sim_output_PID_dt(void *context, int16_t target, int16_t measurement);
+
+/**
+  * @brief  run one closed loop step response from rest
+  * @param  controller, context is the controller under test (e.g. plant_sim_output_PID, &pid)
+  * @param  target is setpoint from time 0
+  * @param  duration_s is simulated time
+  * @param  *result is filled with the metrics
+*/
+void plant_sim_run(const plant_config *config, plant_sim_controller controller, void *context,
+                   int16_t target, float duration_s, plant_sim_result *result);
+
+#endif /* SIM_PLANT_SIM_H_ */
@@ -8,7 +8,7 @@
 #ifndef _PWM_CONTROL_H_
 #define _PWM_CONTROL_H_
 
-#include "main.h"
+#include "../Platform/platform.h"
 //#include "../AVERAGE FILTER/average_filter.h"
 
 #define SERVO_MAX_PULSE 1200  //ums
@@ -24,7 +24,7 @@ enum DIRECTION
 
 typedef struct
 {
-    TIM_HandleTypeDef *htim;
+    platform_timer *htim;
     uint16_t Channel1;
     uint16_t Channel2;
 } PWMcontrol;
@@ -38,13 +38,13 @@ typedef struct
   *            @arg Channel2 : channel handle to go backward, can shorten when known fixed pins
   *
 */
-void Motor_Init(PWMcontrol *motor, TIM_HandleTypeDef *htim, uint32_t Channel1, uint32_t Channel2);
+void Motor_Init(PWMcontrol *motor, platform_timer *htim, uint32_t Channel1, uint32_t Channel2);
 
 /**
   * @brief  Init Motor
   * @param  htim Timer handle of encoder module
 */
-void Servo_Init(PWMcontrol *servo, TIM_HandleTypeDef *htim, uint32_t Channel, uint16_t PWM);
+void Servo_Init(PWMcontrol *servo, platform_timer *htim, uint32_t Channel, uint16_t PWM);
 
 /**
   * @brief  Set speed and direction of motor
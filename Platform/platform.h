@@ -0,0 +1,50 @@
+/*
+ * platform.h
+ *
+ *  Thin bus / timer / GPIO layer between the drivers and the hardware
+ *  STM32 backend (default):     platform_stm32.h, static inline HAL calls, no extra cost
+ *  Linux backend (PLATFORM_SIM): sim/platform_sim.c, scripted register models and simulated time
+ *
+ *  On STM32 the handle types are the HAL ones (platform_i2c is I2C_HandleTypeDef, ...),
+ *  so CubeMX handles (&hi2c1, &htim3, GPIOB) are passed to the drivers as before.
+ *
+ *  Every backend provides:
+ *      bool     platform_i2c_read(platform_i2c *bus, uint16_t address, uint8_t reg, uint8_t *data, uint16_t len, uint32_t timeout)
+ *      bool     platform_i2c_write(platform_i2c *bus, uint16_t address, uint8_t reg, const uint8_t *data, uint16_t len, uint32_t timeout)
+ *      bool     platform_spi_transfer(platform_spi *bus, const uint8_t *tx, uint8_t *rx, uint16_t len, uint32_t timeout)
+ *      void     platform_gpio_write(platform_gpio *port, uint16_t pin, bool level)
+ *      bool     platform_gpio_read(platform_gpio *port, uint16_t pin)
+ *      void     platform_gpio_toggle(platform_gpio *port, uint16_t pin)
+ *      void     platform_timer_start(platform_timer *timer)                   // free running counter
+ *      void     platform_timer_stop(platform_timer *timer)
+ *      void     platform_timer_start_it(platform_timer *timer)                // with update (period elapsed) interrupt
+ *      void     platform_timer_stop_it(platform_timer *timer)
+ *      void     platform_timer_set_period(platform_timer *timer, uint32_t period)   // auto reload
+ *      void     platform_timer_clear_update(platform_timer *timer)
+ *      uint32_t platform_timer_get_counter(platform_timer *timer)
+ *      void     platform_timer_set_counter(platform_timer *timer, uint32_t value)
+ *      bool     platform_timer_counting_down(platform_timer *timer)
+ *      bool     platform_timer_start_encoder(platform_timer *timer)
+ *      void     platform_timer_start_pwm(platform_timer *timer, uint32_t channel)
+ *      void     platform_timer_set_compare(platform_timer *timer, uint32_t channel, uint32_t value)
+ *      void     platform_timer_start_compare_it(platform_timer *timer, uint32_t channel)
+ *      uint32_t platform_timer_read_capture(platform_timer *timer, uint32_t channel)
+ *      void     platform_timer_capture_edge(platform_timer *timer, uint32_t channel, bool rising)
+ *      void     platform_timer_start_capture_it(platform_timer *timer, uint32_t channel)
+ *      void     platform_timer_stop_capture_it(platform_timer *timer, uint32_t channel)
+ *      uint32_t platform_tick_ms(void)
+ *      uint32_t platform_micros(void)                                          // free running, wraps after 71 min
+ *      void     platform_delay_ms(uint32_t ms)
+ *  I2C address is the 8 bit (shifted) one, as HAL_I2C_Mem_Read takes it
+ */
+
+#ifndef _PLATFORM_H_
+#define _PLATFORM_H_
+
+#ifdef PLATFORM_SIM
+#include "sim/platform_sim.h"
+#else
+#include "platform_stm32.h"
+#endif
+
+#endif
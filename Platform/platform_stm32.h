@@ -0,0 +1,117 @@
+/*
+ * platform_stm32.h
+ *
+ *  STM32 HAL backend of platform.h
+ */
+
+#ifndef _PLATFORM_STM32_H_
+#define _PLATFORM_STM32_H_
+
+#include "main.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/* User Configurations */
+// 32 bits timer (TIM2 or TIM5 on F4) free running at 1MHz: prescaler = timer clock / 1MHz - 1,
+// period 0xFFFFFFFF, started once with platform_timer_start
+#ifndef PLATFORM_MICROS_TIM
+#define PLATFORM_MICROS_TIM TIM5
+#endif
+/* End User Configurations */
+
+typedef I2C_HandleTypeDef platform_i2c;
+typedef SPI_HandleTypeDef platform_spi;
+typedef TIM_HandleTypeDef platform_timer;
+typedef GPIO_TypeDef      platform_gpio;
+
+/* Bus */
+static inline bool platform_i2c_read(platform_i2c *bus, uint16_t address, uint8_t reg, uint8_t *data, uint16_t len, uint32_t timeout)
+{
+    return HAL_I2C_Mem_Read(bus, address, reg, I2C_MEMADD_SIZE_8BIT, data, len, timeout) == HAL_OK;
+}
+
+static inline bool platform_i2c_write(platform_i2c *bus, uint16_t address, uint8_t reg, const uint8_t *data, uint16_t len, uint32_t timeout)
+{
+    return HAL_I2C_Mem_Write(bus, address, reg, I2C_MEMADD_SIZE_8BIT, (uint8_t *)data, len, timeout) == HAL_OK;
+}
+
+static inline bool platform_spi_transfer(platform_spi *bus, const uint8_t *tx, uint8_t *rx, uint16_t len, uint32_t timeout)
+{
+    if (rx == NULL) return HAL_SPI_Transmit(bus, (uint8_t *)tx, len, timeout) == HAL_OK;
+    if (tx == NULL) return HAL_SPI_Receive(bus, rx, len, timeout) == HAL_OK;
+    return HAL_SPI_TransmitReceive(bus, (uint8_t *)tx, rx, len, timeout) == HAL_OK;
+}
+
+/* GPIO */
+static inline void platform_gpio_write(platform_gpio *port, uint16_t pin, bool level)
+{
+    HAL_GPIO_WritePin(port, pin, level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+static inline bool platform_gpio_read(platform_gpio *port, uint16_t pin)
+{
+    return HAL_GPIO_ReadPin(port, pin) == GPIO_PIN_SET;
+}
+
+static inline void platform_gpio_toggle(platform_gpio *port, uint16_t pin)
+{
+    HAL_GPIO_TogglePin(port, pin);
+}
+
+/* Timer */
+static inline void platform_timer_start(platform_timer *timer)                  {   HAL_TIM_Base_Start(timer);                      }
+static inline void platform_timer_stop(platform_timer *timer)                   {   HAL_TIM_Base_Stop(timer);                       }
+static inline void platform_timer_start_it(platform_timer *timer)               {   HAL_TIM_Base_Start_IT(timer);                   }
+static inline void platform_timer_stop_it(platform_timer *timer)                {   HAL_TIM_Base_Stop_IT(timer);                    }
+static inline void platform_timer_set_period(platform_timer *timer, uint32_t period)    {   __HAL_TIM_SET_AUTORELOAD(timer, period);    }
+static inline void platform_timer_clear_update(platform_timer *timer)           {   __HAL_TIM_CLEAR_FLAG(timer, TIM_FLAG_UPDATE);   }
+static inline uint32_t platform_timer_get_counter(platform_timer *timer)        {   return __HAL_TIM_GET_COUNTER(timer);            }
+static inline void platform_timer_set_counter(platform_timer *timer, uint32_t value)    {   __HAL_TIM_SET_COUNTER(timer, value);    }
+static inline bool platform_timer_counting_down(platform_timer *timer)          {   return __HAL_TIM_IS_TIM_COUNTING_DOWN(timer);   }
+
+static inline bool platform_timer_start_encoder(platform_timer *timer)
+{
+    return HAL_TIM_Encoder_Start(timer, TIM_CHANNEL_ALL) == HAL_OK;
+}
+
+static inline void platform_timer_start_pwm(platform_timer *timer, uint32_t channel)
+{
+    HAL_TIM_PWM_Start(timer, channel);
+}
+
+static inline void platform_timer_set_compare(platform_timer *timer, uint32_t channel, uint32_t value)
+{
+    __HAL_TIM_SET_COMPARE(timer, channel, value);
+}
+
+static inline void platform_timer_start_compare_it(platform_timer *timer, uint32_t channel)
+{
+    HAL_TIM_OC_Start_IT(timer, channel);
+}
+
+static inline uint32_t platform_timer_read_capture(platform_timer *timer, uint32_t channel)
+{
+    return HAL_TIM_ReadCapturedValue(timer, channel);
+}
+
+static inline void platform_timer_capture_edge(platform_timer *timer, uint32_t channel, bool rising)
+{
+    __HAL_TIM_SET_CAPTUREPOLARITY(timer, channel, rising ? TIM_INPUTCHANNELPOLARITY_RISING : TIM_INPUTCHANNELPOLARITY_FALLING);
+}
+
+static inline void platform_timer_start_capture_it(platform_timer *timer, uint32_t channel)
+{
+    HAL_TIM_IC_Start_IT(timer, channel);
+}
+
+static inline void platform_timer_stop_capture_it(platform_timer *timer, uint32_t channel)
+{
+    HAL_TIM_IC_Stop_IT(timer, channel);
+}
+
+/* Time */
+static inline uint32_t platform_tick_ms(void)       {   return HAL_GetTick();   }
+static inline void platform_delay_ms(uint32_t ms)   {   HAL_Delay(ms);          }
+static inline uint32_t platform_micros(void)        {   return PLATFORM_MICROS_TIM->CNT;    }
+
+#endif
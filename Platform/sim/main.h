@@ -0,0 +1,12 @@
+/*
+ * main.h
+ *
+ *  Host stand-in for the CubeMX main.h, for code which still includes it
+ */
+
+#ifndef SIM_MAIN_H_
+#define SIM_MAIN_H_
+
+#include "platform_sim.h"
+
+#endif /* SIM_MAIN_H_ */
@@ -0,0 +1,317 @@
+/*
+ * platform_sim.c
+ *
+ *  Linux backend of platform.h, register models and simulated time
+ */
+
+#include "platform_sim.h"
+#include <string.h>
+
+platform_gpio platform_sim_port[5];
+
+static uint64_t sim_now_ns;
+static void (*sim_hook[PLATFORM_SIM_HOOKS])(uint64_t now_ns);
+
+static uint8_t channel_index(uint32_t channel)	{	return (channel >> 2) & 0x03;	}
+
+/* Time */
+void platform_sim_init(void)
+{
+	sim_now_ns = 0;
+	memset(sim_hook, 0, sizeof(sim_hook));
+	memset(platform_sim_port, 0, sizeof(platform_sim_port));
+}
+
+uint64_t platform_sim_time_ns(void)	{	return sim_now_ns;	}
+
+void platform_sim_advance_ns(uint64_t ns)
+{
+	sim_now_ns += ns;
+	for (uint8_t i = 0; i < PLATFORM_SIM_HOOKS && sim_hook[i]; i++) sim_hook[i](sim_now_ns);
+}
+
+bool platform_sim_add_hook(void (*hook)(uint64_t now_ns))
+{
+	for (uint8_t i = 0; i < PLATFORM_SIM_HOOKS; i++)
+	{
+		if (sim_hook[i] == NULL || sim_hook[i] == hook)
+		{
+			sim_hook[i] = hook;
+			return true;
+		}
+	}
+	return false;
+}
+
+uint32_t platform_tick_ms(void)
+{
+	platform_sim_advance_ns(PLATFORM_SIM_CALL_NS);
+	return (uint32_t)(sim_now_ns / 1000000);
+}
+
+uint32_t platform_micros(void)
+{
+	platform_sim_advance_ns(PLATFORM_SIM_CALL_NS);
+	return (uint32_t)(sim_now_ns / 1000);
+}
+
+void platform_delay_ms(uint32_t ms)	{	platform_sim_advance_ns((uint64_t)ms * 1000000);	}
+
+__weak void Error_Handler(void)	{	}
+
+/* I2C */
+static void sim_i2c_script(platform_sim_i2c_device *device)
+{
+	if (device->script_length == 0) return;
+
+	for (;;)
+	{
+		uint64_t elapsed_us = (sim_now_ns - device->script_start_ns) / 1000;
+
+		while (device->script_index < device->script_length && device->script[device->script_index].at_us <= elapsed_us)
+		{
+			const platform_sim_step *step = &device->script[device->script_index++];
+			for (uint8_t i = 0; i < step->length && i < sizeof(step->value); i++)
+				device->reg[(uint8_t)(step->reg + i)] = step->value[i];
+		}
+		if (device->script_index < device->script_length || device->script_loop_us == 0
+				|| elapsed_us < device->script_loop_us) return;
+
+		// skip whole loops the bus did not look at, replay the last one
+		uint64_t loops = elapsed_us / device->script_loop_us;
+		device->script_start_ns += (loops > 1 ? loops - 1 : 1) * device->script_loop_us * 1000;
+		device->script_index = 0;
+	}
+}
+
+static platform_sim_i2c_device *sim_i2c_transfer(platform_i2c *bus, uint16_t address, uint16_t len)
+{
+	uint32_t hz = bus->hz ? bus->hz : PLATFORM_SIM_I2C_HZ;
+
+	// address + register (+ repeated start address) + data, 9 clocks per byte
+	bus->transfers++;
+	platform_sim_advance_ns(PLATFORM_SIM_CALL_NS + (uint64_t)(3 + len) * 9 * 1000000000ull / hz);
+
+	for (platform_sim_i2c_device *device = bus->devices; device != NULL; device = device->next)
+	{
+		if (device->address == address)
+		{
+			sim_i2c_script(device);
+			return device;
+		}
+	}
+	bus->naks++;
+	return NULL;
+}
+
+void platform_sim_i2c_attach(platform_i2c *bus, platform_sim_i2c_device *device)
+{
+	device->script_index = 0;
+	device->script_start_ns = sim_now_ns;
+	device->next = bus->devices;
+	bus->devices = device;
+	sim_i2c_script(device);
+}
+
+bool platform_i2c_read(platform_i2c *bus, uint16_t address, uint8_t reg, uint8_t *data, uint16_t len, uint32_t timeout)
+{
+	UNUSED(timeout);
+	platform_sim_i2c_device *device = sim_i2c_transfer(bus, address, len);
+
+	if (device == NULL) return false;
+	device->reads++;
+	for (uint16_t i = 0; i < len; i++) data[i] = device->reg[(uint8_t)(reg + i)];
+	return true;
+}
+
+bool platform_i2c_write(platform_i2c *bus, uint16_t address, uint8_t reg, const uint8_t *data, uint16_t len, uint32_t timeout)
+{
+	UNUSED(timeout);
+	platform_sim_i2c_device *device = sim_i2c_transfer(bus, address, len);
+
+	if (device == NULL) return false;
+	device->writes++;
+	for (uint16_t i = 0; i < len; i++)
+	{
+		uint8_t r = (uint8_t)(reg + i);
+		device->reg[r] = data[i];
+		if (device->on_write) device->on_write(device, r, data[i]);
+	}
+	return true;
+}
+
+/* SPI */
+bool platform_spi_transfer(platform_spi *bus, const uint8_t *tx, uint8_t *rx, uint16_t len, uint32_t timeout)
+{
+	UNUSED(timeout);
+	bus->transfers++;
+	platform_sim_advance_ns(PLATFORM_SIM_CALL_NS);
+	if (bus->transfer == NULL) return false;
+	bus->transfer(bus->context, tx, rx, len);
+	return true;
+}
+
+/* GPIO */
+void platform_gpio_write(platform_gpio *port, uint16_t pin, bool level)
+{
+	platform_sim_advance_ns(PLATFORM_SIM_CALL_NS);
+	if (level)	port->output |= pin;
+	else		port->output &= ~pin;
+	if (port->on_write) port->on_write(port, pin, level);
+}
+
+bool platform_gpio_read(platform_gpio *port, uint16_t pin)
+{
+	bool level = (port->input & pin) != 0;
+
+	platform_sim_advance_ns(PLATFORM_SIM_CALL_NS);
+	return port->on_read ? port->on_read(port, pin, level) : level;
+}
+
+void platform_gpio_toggle(platform_gpio *port, uint16_t pin)
+{
+	platform_gpio_write(port, pin, (port->output & pin) == 0);
+}
+
+/* Timer */
+static void sim_timer_sync(platform_timer *timer)
+{
+	uint32_t tick_ns = timer->tick_ns ? timer->tick_ns : 1000;
+	uint64_t wrap = (uint64_t)(timer->period ? timer->period : 0xFFFF) + 1;
+
+	if (timer->running && !timer->encoder)
+	{
+		uint64_t ticks = (sim_now_ns - timer->sync_ns) / tick_ns;
+		if (timer->counter + ticks >= wrap) timer->update_pending = true;
+		timer->counter = (uint32_t)((timer->counter + ticks) % wrap);
+		timer->sync_ns += ticks * tick_ns;
+	}
+	else
+	{
+		timer->sync_ns = sim_now_ns;
+	}
+}
+
+void platform_timer_start(platform_timer *timer)
+{
+	sim_timer_sync(timer);
+	timer->running = true;
+}
+
+void platform_timer_stop(platform_timer *timer)
+{
+	sim_timer_sync(timer);
+	timer->running = false;
+}
+
+void platform_timer_start_it(platform_timer *timer)
+{
+	platform_timer_start(timer);
+	timer->update_it = true;
+}
+
+void platform_timer_stop_it(platform_timer *timer)
+{
+	platform_timer_stop(timer);
+	timer->update_it = false;
+}
+
+void platform_timer_set_period(platform_timer *timer, uint32_t period)
+{
+	sim_timer_sync(timer);
+	timer->period = period;
+}
+
+void platform_timer_clear_update(platform_timer *timer)
+{
+	sim_timer_sync(timer);
+	timer->update_pending = false;
+}
+
+uint32_t platform_timer_get_counter(platform_timer *timer)
+{
+	platform_sim_advance_ns(PLATFORM_SIM_CALL_NS);
+	sim_timer_sync(timer);
+	return timer->counter;
+}
+
+void platform_timer_set_counter(platform_timer *timer, uint32_t value)
+{
+	sim_timer_sync(timer);
+	timer->counter = value;
+}
+
+bool platform_timer_counting_down(platform_timer *timer)	{	return timer->counting_down;	}
+
+bool platform_timer_start_encoder(platform_timer *timer)
+{
+	timer->encoder = true;
+	timer->running = true;
+	return true;
+}
+
+void platform_timer_start_pwm(platform_timer *timer, uint32_t channel)
+{
+	timer->pwm[channel_index(channel)] = true;
+	timer->running = true;
+}
+
+void platform_timer_set_compare(platform_timer *timer, uint32_t channel, uint32_t value)
+{
+	platform_sim_advance_ns(PLATFORM_SIM_CALL_NS);
+	timer->compare[channel_index(channel)] = value;
+}
+
+void platform_timer_start_compare_it(platform_timer *timer, uint32_t channel)
+{
+	timer->compare_it[channel_index(channel)] = true;
+	platform_timer_start(timer);
+}
+
+uint32_t platform_timer_read_capture(platform_timer *timer, uint32_t channel)
+{
+	return timer->capture[channel_index(channel)];
+}
+
+void platform_timer_capture_edge(platform_timer *timer, uint32_t channel, bool rising)
+{
+	timer->capture_falling[channel_index(channel)] = !rising;
+}
+
+void platform_timer_start_capture_it(platform_timer *timer, uint32_t channel)
+{
+	timer->capture_it[channel_index(channel)] = true;
+	platform_timer_start(timer);
+}
+
+void platform_timer_stop_capture_it(platform_timer *timer, uint32_t channel)
+{
+	timer->capture_it[channel_index(channel)] = false;
+}
+
+bool platform_sim_timer_elapsed(platform_timer *timer)
+{
+	sim_timer_sync(timer);
+	if (!timer->update_it || !timer->update_pending) return false;
+	timer->update_pending = false;
+	return true;
+}
+
+void platform_sim_encoder_move(platform_timer *timer, int32_t pulses)
+{
+	int64_t wrap = (int64_t)(timer->period ? timer->period : 0xFFFF) + 1;
+	int64_t counter = ((int64_t)timer->counter + pulses) % wrap;
+
+	timer->counter = (uint32_t)(counter < 0 ? counter + wrap : counter);
+	timer->counting_down = pulses < 0;
+}
+
+bool platform_sim_capture(platform_timer *timer, uint32_t channel, bool rising)
+{
+	uint8_t i = channel_index(channel);
+
+	if (!timer->capture_it[i] || timer->capture_falling[i] == rising) return false;
+	sim_timer_sync(timer);
+	timer->capture[i] = timer->counter;
+	return true;
+}
@@ -0,0 +1,228 @@
+/*
+ * platform_sim.h
+ *
+ *  Linux backend of platform.h (build with -D PLATFORM_SIM -I Platform/sim)
+ *  Time is simulated: it only moves when the drivers use a bus, a delay or poll a timer,
+ *  or when the test calls platform_sim_advance_ns.
+ *
+ *  I2C slaves are register models: a 256 byte register file plus a script of
+ *  timed register writes (new sensor samples), applied when the bus touches the device.
+ *  SPI slaves and GPIO side effects are callbacks (see nRF24L01/sim).
+ *
+ *  Example (MPU6050 giving a new gyro sample every 1 ms):
+ *      static const platform_sim_step gyro_script[] = {
+ *          {    0, GYRO_XOUT_H, 6, {0x00, 0x41, 0xFF, 0xBF, 0x00, 0x00} },
+ *          { 1000, GYRO_XOUT_H, 6, {0x00, 0x42, 0xFF, 0xBE, 0x00, 0x01} },
+ *      };
+ *      platform_i2c hi2c1;
+ *      platform_sim_i2c_device mpu = { .address = MPU6050_ADDR, .script = gyro_script,
+ *                                      .script_length = 2, .script_loop_us = 2000 };
+ *
+ *      platform_sim_init();
+ *      mpu.reg[WHO_AM_I] = 0x68;
+ *      platform_sim_i2c_attach(&hi2c1, &mpu);
+ *      mpu6050_init(&imu);
+ */
+
+#ifndef _PLATFORM_SIM_H_
+#define _PLATFORM_SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/* User Configurations */
+#define PLATFORM_SIM_CALL_NS    100     // cost of one register access / HAL call
+#define PLATFORM_SIM_I2C_HZ     400000  // default I2C clock
+#define PLATFORM_SIM_HOOKS      4       // device models following simulated time
+/* End User Configurations */
+
+/* Script of an I2C device: at at_us (from script start) value[] is written from reg on */
+typedef struct
+{
+    uint32_t at_us;
+    uint8_t reg;
+    uint8_t length;
+    uint8_t value[8];
+} platform_sim_step;
+
+typedef struct platform_sim_i2c_device
+{
+    uint16_t address;                       // 8 bit address, as the driver passes it
+    uint8_t reg[256];
+    const platform_sim_step *script;
+    uint16_t script_length;
+    uint32_t script_loop_us;                // 0 = run script once
+    uint16_t script_index;
+    uint64_t script_start_ns;
+    // optional side effect of a master write (e.g. start conversion), reg[] is already written
+    void (*on_write)(struct platform_sim_i2c_device *device, uint8_t reg, uint8_t value);
+    uint32_t reads;
+    uint32_t writes;
+    struct platform_sim_i2c_device *next;
+} platform_sim_i2c_device;
+
+typedef struct
+{
+    platform_sim_i2c_device *devices;
+    uint32_t hz;                            // 0 = PLATFORM_SIM_I2C_HZ
+    uint32_t transfers;
+    uint32_t naks;                          // transfers to an address nobody answers
+} platform_i2c;
+
+typedef struct
+{
+    // device model, one full duplex transfer (CS is a GPIO of the driver)
+    void (*transfer)(void *context, const uint8_t *tx, uint8_t *rx, uint16_t len);
+    void *context;
+    uint32_t transfers;
+} platform_spi;
+
+typedef struct platform_gpio
+{
+    uint16_t output;                        // last level written by the driver
+    uint16_t input;                         // level seen by the driver, set by test or model
+    // optional device models, on_read gets the input level and returns what the driver sees
+    void (*on_write)(struct platform_gpio *port, uint16_t pin, bool level);
+    bool (*on_read)(struct platform_gpio *port, uint16_t pin, bool level);
+} platform_gpio;
+
+typedef struct
+{
+    uint32_t counter;
+    uint32_t period;                        // ARR, counter wraps after it (0 = 0xFFFF)
+    uint32_t tick_ns;                       // counter clock, 0 = 1000 (1 MHz)
+    uint32_t compare[4];
+    uint32_t capture[4];
+    bool capture_falling[4];                // polarity, rising after reset
+    bool capture_it[4];
+    bool compare_it[4];
+    bool pwm[4];
+    bool running;                           // counts with simulated time
+    bool update_it;                         // update interrupt enabled
+    bool update_pending;                    // counter wrapped (update flag)
+    bool encoder;                           // counter only moves by platform_sim_encoder_move
+    bool counting_down;
+    uint64_t sync_ns;
+} platform_timer;
+
+/* HAL names, so user configurations and application code build unchanged */
+typedef platform_i2c   I2C_HandleTypeDef;
+typedef platform_spi   SPI_HandleTypeDef;
+typedef platform_timer TIM_HandleTypeDef;
+typedef platform_gpio  GPIO_TypeDef;
+
+extern platform_gpio platform_sim_port[5];
+#define GPIOA           (&platform_sim_port[0])
+#define GPIOB           (&platform_sim_port[1])
+#define GPIOC           (&platform_sim_port[2])
+#define GPIOD           (&platform_sim_port[3])
+#define GPIOE           (&platform_sim_port[4])
+
+#define GPIO_PIN_0      ((uint16_t)0x0001)
+#define GPIO_PIN_1      ((uint16_t)0x0002)
+#define GPIO_PIN_2      ((uint16_t)0x0004)
+#define GPIO_PIN_3      ((uint16_t)0x0008)
+#define GPIO_PIN_4      ((uint16_t)0x0010)
+#define GPIO_PIN_5      ((uint16_t)0x0020)
+#define GPIO_PIN_6      ((uint16_t)0x0040)
+#define GPIO_PIN_7      ((uint16_t)0x0080)
+#define GPIO_PIN_8      ((uint16_t)0x0100)
+#define GPIO_PIN_9      ((uint16_t)0x0200)
+#define GPIO_PIN_10     ((uint16_t)0x0400)
+#define GPIO_PIN_11     ((uint16_t)0x0800)
+#define GPIO_PIN_12     ((uint16_t)0x1000)
+#define GPIO_PIN_13     ((uint16_t)0x2000)
+#define GPIO_PIN_14     ((uint16_t)0x4000)
+#define GPIO_PIN_15     ((uint16_t)0x8000)
+
+#define TIM_CHANNEL_1   0x00000000U
+#define TIM_CHANNEL_2   0x00000004U
+#define TIM_CHANNEL_3   0x00000008U
+#define TIM_CHANNEL_4   0x0000000CU
+#define TIM_CHANNEL_ALL 0x0000003CU
+
+#define __weak          __attribute__((weak))
+#define UNUSED(X)       (void)X
+
+void Error_Handler(void);
+
+/* platform.h interface */
+bool platform_i2c_read(platform_i2c *bus, uint16_t address, uint8_t reg, uint8_t *data, uint16_t len, uint32_t timeout);
+bool platform_i2c_write(platform_i2c *bus, uint16_t address, uint8_t reg, const uint8_t *data, uint16_t len, uint32_t timeout);
+bool platform_spi_transfer(platform_spi *bus, const uint8_t *tx, uint8_t *rx, uint16_t len, uint32_t timeout);
+
+void platform_gpio_write(platform_gpio *port, uint16_t pin, bool level);
+bool platform_gpio_read(platform_gpio *port, uint16_t pin);
+void platform_gpio_toggle(platform_gpio *port, uint16_t pin);
+
+void platform_timer_start(platform_timer *timer);
+void platform_timer_stop(platform_timer *timer);
+void platform_timer_start_it(platform_timer *timer);
+void platform_timer_stop_it(platform_timer *timer);
+void platform_timer_set_period(platform_timer *timer, uint32_t period);
+void platform_timer_clear_update(platform_timer *timer);
+uint32_t platform_timer_get_counter(platform_timer *timer);
+void platform_timer_set_counter(platform_timer *timer, uint32_t value);
+bool platform_timer_counting_down(platform_timer *timer);
+bool platform_timer_start_encoder(platform_timer *timer);
+void platform_timer_start_pwm(platform_timer *timer, uint32_t channel);
+void platform_timer_set_compare(platform_timer *timer, uint32_t channel, uint32_t value);
+void platform_timer_start_compare_it(platform_timer *timer, uint32_t channel);
+uint32_t platform_timer_read_capture(platform_timer *timer, uint32_t channel);
+void platform_timer_capture_edge(platform_timer *timer, uint32_t channel, bool rising);
+void platform_timer_start_capture_it(platform_timer *timer, uint32_t channel);
+void platform_timer_stop_capture_it(platform_timer *timer, uint32_t channel);
+
+uint32_t platform_tick_ms(void);
+void platform_delay_ms(uint32_t ms);
+uint32_t platform_micros(void);
+
+/* Simulation control */
+
+/**
+  * @brief  Reset simulated time, GPIO ports and time hooks
+*/
+void platform_sim_init(void);
+
+/**
+  * @brief  Current simulated time in ns
+*/
+uint64_t platform_sim_time_ns(void);
+
+/**
+  * @brief  Let simulated time pass (time hooks run after)
+  * @param  ns is time to advance
+*/
+void platform_sim_advance_ns(uint64_t ns);
+
+/**
+  * @brief  Call hook every time simulated time moves (device model timing)
+  * @return false if PLATFORM_SIM_HOOKS hooks are already in use
+*/
+bool platform_sim_add_hook(void (*hook)(uint64_t now_ns));
+
+/**
+  * @brief  Connect an I2C register model to a bus, its script starts now
+*/
+void platform_sim_i2c_attach(platform_i2c *bus, platform_sim_i2c_device *device);
+
+/**
+  * @brief  Check and clear the update flag of a timer with update interrupt on
+  * @return true if the period elapsed, the test then calls the driver period elapsed callback
+*/
+bool platform_sim_timer_elapsed(platform_timer *timer);
+
+/**
+  * @brief  Move an encoder timer by pulses (negative = counting down)
+*/
+void platform_sim_encoder_move(platform_timer *timer, int32_t pulses);
+
+/**
+  * @brief  Latch the current counter into a capture channel (edge on input pin)
+  * @return true if the edge matches the channel polarity and capture interrupt is on,
+  *         the test then calls the driver capture callback
+*/
+bool platform_sim_capture(platform_timer *timer, uint32_t channel, bool rising);
+
+#endif
@@ -0,0 +1,124 @@
+/*
+ * profiler.c
+ *
+ *  Cycle counting probes for hot paths
+ */
+
+#include "profiler.h"
+
+#if PROFILER_ENABLE
+
+#include <stdio.h>
+
+#if defined(__CORTEX_M)
+#define profiler_lock()     uint32_t primask = __get_PRIMASK(); __disable_irq()
+#define profiler_unlock()   __set_PRIMASK(primask)
+#else
+// host: probes are recorded from one thread
+#define profiler_lock()
+#define profiler_unlock()
+#endif
+
+static profiler_probe *profiler_list;
+static uint32_t profiler_overhead;
+
+static uint8_t profiler_bin(uint32_t ticks)
+{
+    uint8_t bin = (ticks == 0) ? 0 : 31 - __builtin_clz(ticks);
+    return (bin < PROFILER_HIST_BINS) ? bin : PROFILER_HIST_BINS - 1;
+}
+
+static void profiler_clear(profiler_probe *probe)
+{
+    probe->count = 0;
+    probe->min = UINT32_MAX;
+    probe->max = 0;
+    probe->sum = 0;
+    for (uint8_t i = 0; i < PROFILER_HIST_BINS; i++) probe->hist[i] = 0;
+}
+
+void profiler_init(void)
+{
+#if defined(__CORTEX_M)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    // smallest of a few empty probes, the first one may still miss the cache
+    profiler_overhead = UINT32_MAX;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        PROFILE_BEGIN(start);
+        uint32_t ticks = profiler_now() - start;
+        if (ticks < profiler_overhead) profiler_overhead = ticks;
+    }
+}
+
+void profiler_record(profiler_probe *probe, uint32_t ticks)
+{
+    ticks = (ticks > profiler_overhead) ? ticks - profiler_overhead : 0;
+    uint8_t bin = profiler_bin(ticks);
+
+    profiler_lock();
+    if (!probe->linked)
+    {
+        probe->linked = 1;
+        probe->next = profiler_list;
+        profiler_list = probe;
+    }
+    probe->count++;
+    probe->sum += ticks;
+    if (ticks < probe->min) probe->min = ticks;
+    if (ticks > probe->max) probe->max = ticks;
+    probe->hist[bin]++;
+    profiler_unlock();
+}
+
+void profiler_reset(void)
+{
+    for (profiler_probe *probe = profiler_list; probe != NULL; probe = probe->next)
+    {
+        profiler_lock();
+        profiler_clear(probe);
+        profiler_unlock();
+    }
+}
+
+void profiler_dump(profiler_write write)
+{
+    char line[96];
+    int len;
+
+    for (profiler_probe *probe = profiler_list; probe != NULL; probe = probe->next)
+    {
+        // snapshot so the line is consistent while ISRs keep recording
+        profiler_probe copy;
+        profiler_lock();
+        copy = *probe;
+        profiler_unlock();
+        if (copy.count == 0) continue;
+
+        len = snprintf(line, sizeof(line), "%s: n=%lu min=%lu mean=%lu max=%lu " PROFILER_TICK_UNIT "\r\n",
+                       copy.name, (unsigned long)copy.count, (unsigned long)copy.min,
+                       (unsigned long)(copy.sum / copy.count), (unsigned long)copy.max);
+        write(line, (uint16_t)len);
+
+        len = snprintf(line, sizeof(line), "  hist:");
+        for (uint8_t i = 0; i < PROFILER_HIST_BINS; i++)
+        {
+            if (copy.hist[i] == 0) continue;
+            if (len > (int)sizeof(line) - 24)
+            {
+                write(line, (uint16_t)len);
+                len = 0;
+            }
+            len += snprintf(line + len, sizeof(line) - len, " %s%lu:%lu", (i == PROFILER_HIST_BINS - 1) ? ">=" : "",
+                            (unsigned long)(1ul << i), (unsigned long)copy.hist[i]);
+        }
+        len += snprintf(line + len, sizeof(line) - len, "\r\n");
+        write(line, (uint16_t)len);
+    }
+}
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ * profiler.h
+ *
+ *  Cycle counting probes for hot paths (DWT->CYCCNT on Cortex-M, clock_gettime on host)
+ *  Host builds define PLATFORM_SIM or PROFILER_HOST (e.g. -D PROFILER_HOST on a Raspberry Pi)
+ *  Each probe keeps count, min, max, mean and a log2 histogram of its duration
+ *  Recording is ISR safe, with PROFILER_ENABLE = 0 every probe compiles to nothing
+ *
+ *  Example:
+ *      PROFILE_PROBE(encoder_probe);
+ *
+ *      profiler_init();
+ *
+ *      void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim)
+ *      {
+ *          PROFILE_BEGIN(start);
+ *          updateEncoder(&enc, true);
+ *          PROFILE_END(encoder_probe, start);
+ *      }
+ *
+ *      void uart_write(const char *text, uint16_t len) { HAL_UART_Transmit(&huart2, (uint8_t *)text, len, 100); }
+ *      profiler_dump(uart_write);  // or a wrapper of CDC_Transmit_FS
+ */
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+// host: CLOCK_MONOTONIC is POSIX, strict C11 (-std=c11) hides it unless requested before the first system header
+#if (defined(PLATFORM_SIM) || defined(PROFILER_HOST)) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* User Configurations */
+#ifndef PROFILER_ENABLE
+#define PROFILER_ENABLE     0   // 0 = probes compile to nothing
+#endif
+#define PROFILER_HIST_BINS  16  // bin k counts 2^k .. 2^(k+1) - 1 ticks (bin 0 also 0), last bin takes the rest
+/* End User Configurations */
+
+// DWT keys on __CORTEX_M of the CMSIS core header, __arm__ is also set on 32 bit ARM Linux
+#if !defined(PLATFORM_SIM) && !defined(PROFILER_HOST)
+#include "main.h"
+#endif
+
+#if defined(__CORTEX_M)
+#define PROFILER_TICK_UNIT "cyc"
+#else
+#include <time.h>
+#define PROFILER_TICK_UNIT "ns"
+#endif
+
+typedef struct profiler_probe
+{
+    const char *name;
+    struct profiler_probe *next;        // list of recorded probes
+    uint8_t linked;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;                       // mean = sum / count
+    uint32_t hist[PROFILER_HIST_BINS];
+} profiler_probe;
+
+typedef void (*profiler_write)(const char *text, uint16_t len);
+
+#if PROFILER_ENABLE
+
+#define PROFILE_PROBE(probe)        profiler_probe probe = { #probe, NULL, 0, 0, UINT32_MAX, 0, 0, {0} }
+#define PROFILE_BEGIN(start)        uint32_t start = profiler_now()
+#define PROFILE_END(probe, start)   profiler_record(&(probe), profiler_now() - (start))
+
+static inline uint32_t profiler_now(void)
+{
+#if defined(__CORTEX_M)
+    return DWT->CYCCNT;
+#else
+    struct timespec now;
+#if defined(CLOCK_MONOTONIC)
+    clock_gettime(CLOCK_MONOTONIC, &now);
+#else
+    timespec_get(&now, TIME_UTC);   // profiler.h included after a system header in strict C11
+#endif
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+#endif
+}
+
+/**
+  * @brief  Start the cycle counter and measure the cost of an empty probe
+  *         (that cost is subtracted from every record)
+*/
+void profiler_init(void);
+
+/**
+  * @brief  Add one duration to a probe (safe from ISR and main loop)
+  * @param  *probe is pointer to the probe structure
+  * @param  ticks is duration in cycles (ns on host)
+*/
+void profiler_record(profiler_probe *probe, uint32_t ticks);
+
+/**
+  * @brief  Clear statistics of every recorded probe
+*/
+void profiler_reset(void);
+
+/**
+  * @brief  Print one line per probe (count, min, mean, max, histogram)
+  * @param  write is called for every line, e.g. a wrapper of HAL_UART_Transmit or CDC_Transmit_FS
+*/
+void profiler_dump(profiler_write write);
+
+#else
+
+#define PROFILE_PROBE(probe)        extern int profiler_unused_   // file scope "PROFILE_PROBE(p);" stays a declaration
+#define PROFILE_BEGIN(start)
+#define PROFILE_END(probe, start)
+#define profiler_init()             ((void)0)
+#define profiler_record(probe, ticks) ((void)(ticks))
+#define profiler_reset()            ((void)0)
+#define profiler_dump(write)        ((void)(write))
+
+#endif
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * spsc_stress.c
+ *
+ *  Concurrent stress test of spsc_ring.h on the host
+ *  One producer thread and one consumer thread share a small ring, so it is full and
+ *  empty very often. Every item carries its sequence number in several words: the
+ *  consumer checks that nothing is lost, repeated, reordered or torn (half written).
+ *  Exit code is 0 when every item is received in order.
+ *
+ *  Build and run (from the repository root):
+ *    gcc -O2 -pthread RingBuffer/sim/spsc_stress.c -o spsc_stress
+ *    ./spsc_stress
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <time.h>
+#include "../spsc_ring.h"
+
+#ifndef STRESS_ITEMS
+#define STRESS_ITEMS    2000000u
+#endif
+#define STRESS_CAPACITY 16
+
+typedef struct
+{
+    uint32_t sequence;
+    uint32_t inverse;       // ~sequence
+    uint64_t square;        // sequence * sequence
+} stress_item;
+
+SPSC_RING_DEFINE(stress_ring, stress_item, STRESS_CAPACITY)
+
+static stress_ring ring;
+static uint32_t producer_full;
+
+static bool item_valid(const stress_item *item)
+{
+    return item->inverse == ~item->sequence && item->square == (uint64_t)item->sequence * item->sequence;
+}
+
+static void *producer(void *arg)
+{
+    (void)arg;
+    for (uint32_t i = 0; i < STRESS_ITEMS; i++)
+    {
+        stress_item item = {i, ~i, (uint64_t)i * i};
+        while (!stress_ring_push(&ring, &item))
+        {
+            producer_full++;
+            sched_yield();  // one core: let the consumer run
+        }
+    }
+    return NULL;
+}
+
+static double seconds_now(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+    pthread_t thread;
+    stress_item item, latest;
+    uint32_t expected = 0, errors = 0, consumer_empty = 0, peeks = 0;
+
+    stress_ring_init(&ring);
+    double start = seconds_now();
+    pthread_create(&thread, NULL, producer, NULL);
+
+    while (expected < STRESS_ITEMS)
+    {
+        // newest item is at least as new as the next one to pop
+        if ((expected & 0xFF) == 0 && stress_ring_peek_latest(&ring, &latest))
+        {
+            peeks++;
+            if (!item_valid(&latest) || latest.sequence < expected) errors++;
+        }
+
+        if (!stress_ring_pop(&ring, &item))
+        {
+            consumer_empty++;
+            sched_yield();
+            continue;
+        }
+        if (!item_valid(&item) || item.sequence != expected)
+        {
+            if (errors++ < 10) printf("item %u: got %u\n", expected, item.sequence);
+        }
+        expected++;
+    }
+
+    pthread_join(thread, NULL);
+    double elapsed = seconds_now() - start;
+
+    printf("%u items through %u slots in %.3f s (%.1f M items/s)\n",
+           STRESS_ITEMS, STRESS_CAPACITY, elapsed, STRESS_ITEMS / elapsed / 1e6);
+    printf("ring full %u times, empty %u times, %u peeks, %u left\n",
+           producer_full, consumer_empty, peeks, stress_ring_count(&ring));
+    printf("%s: %u errors\n", errors ? "FAIL" : "PASS", errors);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+/*
+ * spsc_ring.h
+ *
+ *  Lock-free single producer / single consumer ring buffer (header only)
+ *  Producer is one context (e.g. an ISR), consumer is another (e.g. main loop)
+ *  No allocation, capacity is a power of 2, element type is chosen per ring
+ *
+ *  Example:
+ *      SPSC_RING_DEFINE(rpm_ring, int32_t, 16)
+ *
+ *      rpm_ring ring;
+ *      rpm_ring_init(&ring);
+ *      rpm_ring_push(&ring, &rpm);       // ISR
+ *      while (rpm_ring_pop(&ring, &rpm)) // main loop
+ */
+
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// data must reach memory before the index which publishes it (and the other way round)
+#if defined(__CORTEX_M)
+#define SPSC_BARRIER() __DMB()
+#else
+#define SPSC_BARRIER() __sync_synchronize()
+#endif
+
+#define SPSC_RING_DEFINE(name, type, CAPACITY)                                  \
+_Static_assert(((CAPACITY) & ((CAPACITY) - 1)) == 0 && (CAPACITY) > 0,          \
+               #name " capacity must be a power of 2");                         \
+                                                                                \
+typedef struct                                                                  \
+{                                                                               \
+    type buffer[CAPACITY];                                                      \
+    volatile uint32_t head;  /* written by producer only */                     \
+    volatile uint32_t tail;  /* written by consumer only */                     \
+} name;                                                                         \
+                                                                                \
+static inline void name##_init(name *ring)                                      \
+{                                                                               \
+    ring->head = 0;                                                             \
+    ring->tail = 0;                                                             \
+}                                                                               \
+                                                                                \
+/* producer side, false when full (item is dropped) */                          \
+static inline bool name##_push(name *ring, const type *item)                    \
+{                                                                               \
+    uint32_t head = ring->head;                                                 \
+    if (head - ring->tail >= (CAPACITY)) return false;                          \
+    SPSC_BARRIER();  /* slot is read by consumer before it is overwritten */    \
+    ring->buffer[head & ((CAPACITY) - 1)] = *item;                              \
+    SPSC_BARRIER();                                                             \
+    ring->head = head + 1;                                                      \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/* consumer side, false when empty */                                           \
+static inline bool name##_pop(name *ring, type *item)                           \
+{                                                                               \
+    uint32_t tail = ring->tail;                                                 \
+    if (tail == ring->head) return false;                                       \
+    SPSC_BARRIER();                                                             \
+    *item = ring->buffer[tail & ((CAPACITY) - 1)];                              \
+    SPSC_BARRIER();                                                             \
+    ring->tail = tail + 1;                                                      \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+/* consumer side, newest item without removing anything, false when empty */    \
+static inline bool name##_peek_latest(name *ring, type *item)                   \
+{                                                                               \
+    uint32_t head = ring->head;                                                 \
+    if (head == ring->tail) return false;                                       \
+    SPSC_BARRIER();                                                             \
+    *item = ring->buffer[(head - 1) & ((CAPACITY) - 1)];                        \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+static inline uint32_t name##_count(const name *ring)                           \
+{                                                                               \
+    return ring->head - ring->tail;                                             \
+}
+
+#endif
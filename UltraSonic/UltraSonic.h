@@ -8,7 +8,8 @@
 #ifndef _ULTRA_SONIC_
 #define _ULTRA_SONIC_
 
-#include "..\AVERAGE FILTER\average_filter.h"
+#include "../Platform/platform.h"
+#include "../AVERAGE FILTER/average_filter.h"
 #include <stdbool.h>
 
 #define SOUND_SPEED 34320 // cm/s
@@ -18,10 +19,10 @@
 
 typedef struct
 {
-    TIM_HandleTypeDef *htim;
+    platform_timer *htim;
     volatile uint16_t pre_time;
     volatile double distance; // in cm
-    GPIO_TypeDef *TrigPort;
+    platform_gpio *TrigPort;
     uint32_t TrigPin;
     bool echoHigh;
     average_filter *filter;
@@ -33,7 +34,7 @@ typedef struct
   * @param  *htim is timer used for edge detect echo pin
   * @param  *TrigPort, TrigPin is port and pin of trig pin
 */
-void ultraSonic_Init(ultraSonic *sensor, TIM_HandleTypeDef *htim, average_filter *filter, GPIO_TypeDef *TrigPort, uint16_t TrigPin);
+void ultraSonic_Init(ultraSonic *sensor, platform_timer *htim, average_filter *filter, platform_gpio *TrigPort, uint16_t TrigPin);
 
 /**
   * @brief  update all paramater in ultra sonic structure
@@ -52,7 +53,7 @@ void activeTrigger(ultraSonic *sensor);
   * @param  *htim is timer used for edge detect echo pin
   * @param  time is the time you need to delay
 **/
-void delay_us(TIM_HandleTypeDef *htim, uint16_t time);
+void delay_us(platform_timer *htim, uint16_t time);
 
 
 #endif
@@ -1,6 +1,6 @@
-#include "ultraSonic.h"
+#include "UltraSonic.h"
 
-void ultraSonic_Init(ultraSonic *sensor, TIM_HandleTypeDef *htim, average_filter *filter, GPIO_TypeDef *TrigPort, uint16_t TrigPin)
+void ultraSonic_Init(ultraSonic *sensor, platform_timer *htim, average_filter *filter, platform_gpio *TrigPort, uint16_t TrigPin)
 {
     sensor->htim = htim;
     sensor->pre_time = 0;
@@ -9,7 +9,7 @@ void ultraSonic_Init(ultraSonic *sensor, TIM_HandleTypeDef *htim, average_filter
     sensor->TrigPin = TrigPin;
     sensor->echoHigh = false;
     sensor->filter = filter;
-    HAL_GPIO_WritePin(sensor->TrigPort, sensor->TrigPin, 0);
+    platform_gpio_write(sensor->TrigPort, sensor->TrigPin, 0);
     reset_buffer(sensor->filter);
 }
 
@@ -18,21 +18,21 @@ void updateDistance(ultraSonic *sensor, uint32_t Channel)
 {
     if (sensor->echoHigh == false)
     {
-        sensor->pre_time = HAL_TIM_ReadCapturedValue(sensor->htim, Channel);
-        __HAL_TIM_SET_CAPTUREPOLARITY(sensor->htim, Channel, TIM_INPUTCHANNELPOLARITY_FALLING);
+        sensor->pre_time = platform_timer_read_capture(sensor->htim, Channel);
+        platform_timer_capture_edge(sensor->htim, Channel, false);
         sensor->echoHigh = true;
     }
     else
     {
         // uint32_t diffTime = (sensor->htim->Instance->CCR1 - sensor->pre_time + TIMER_STEP_CYCLE) % TIMER_STEP_CYCLE;
-        uint32_t diffTime = (HAL_TIM_ReadCapturedValue(sensor->htim, Channel) - sensor->pre_time + TIMER_STEP_CYCLE) % TIMER_STEP_CYCLE;
+        uint32_t diffTime = (platform_timer_read_capture(sensor->htim, Channel) - sensor->pre_time + TIMER_STEP_CYCLE) % TIMER_STEP_CYCLE;
 
         apply_filter(sensor->filter, diffTime);
         sensor->distance = ((SOUND_SPEED * STEP_TIMER) * (sensor->filter->out)) / 2.0;
         sensor->echoHigh = false;
 
-        __HAL_TIM_SET_CAPTUREPOLARITY(sensor->htim, Channel, TIM_INPUTCHANNELPOLARITY_RISING);
-        HAL_TIM_IC_Stop_IT(sensor->htim, Channel);
+        platform_timer_capture_edge(sensor->htim, Channel, true);
+        platform_timer_stop_capture_it(sensor->htim, Channel);
     }
     // if (sensor->htim->Channel == HAL_TIM_ACTIVE_CHANNEL_1)
     // {
@@ -77,17 +77,17 @@ void updateDistance(ultraSonic *sensor, uint32_t Channel)
 
 void activeTrigger(ultraSonic *sensor)
 {
-    HAL_GPIO_WritePin(sensor->TrigPort, sensor->TrigPin, 1);
+    platform_gpio_write(sensor->TrigPort, sensor->TrigPin, 1);
     delay_us(sensor->htim, 10);
-    HAL_GPIO_WritePin(sensor->TrigPort, sensor->TrigPin, 0);
+    platform_gpio_write(sensor->TrigPort, sensor->TrigPin, 0);
 //    __HAL_TIM_ENABLE_IT(sensor->htim, TIM_IT_CC1);
     // __HAL_TIM_ENABLE_IT(sensor->htim, TIM_IT_CC2);
 }
 
-void delay_us(TIM_HandleTypeDef *htim, uint16_t time)
+void delay_us(platform_timer *htim, uint16_t time)
 {
-	HAL_TIM_Base_Start(htim);
-    htim->Instance->CNT = 0; // __HAL_TIM_SET_COUNTER(&htim, Cnt);
-    while (htim->Instance->CNT < time); // while (__HAL_TIM_GET_COUNTER(&htim) < time)
-    HAL_TIM_Base_Stop(htim);
+    platform_timer_start(htim);
+    platform_timer_set_counter(htim, 0);
+    while (platform_timer_get_counter(htim) < time);
+    platform_timer_stop(htim);
 }
@@ -7,139 +7,202 @@
 
 #include "nRF24L01.h"
 
-void CS_select() 	{ HAL_GPIO_WritePin(NRF24L01_SPI_CS_PIN_PORT, NRF24L01_SPI_CS_PIN_NUMBER, 0); }
-void CS_unselect()	{ HAL_GPIO_WritePin(NRF24L01_SPI_CS_PIN_PORT, NRF24L01_SPI_CS_PIN_NUMBER, 1); }
-void CE_enable()	{ HAL_GPIO_WritePin(NRF24L01_CE_PIN_PORT, NRF24L01_CE_PIN_NUMBER, 1); }
-void CE_disable()	{ HAL_GPIO_WritePin(NRF24L01_CE_PIN_PORT, NRF24L01_CE_PIN_NUMBER, 0); }
+static nrf24l01_link_stats link_stats;
+static volatile uint8_t bus_lock;
 
+// shadow registers, setters modify them without reading the chip
+static uint8_t shadow_config     = 0x08;
+static uint8_t shadow_rf_setup   = 0x0F;
+static uint8_t shadow_setup_retr = 0x03;
 
-uint8_t nrf24l01_write_reg(uint8_t address, uint8_t data)
+void CS_select() 	{ platform_gpio_write(NRF24L01_SPI_CS_PIN_PORT, NRF24L01_SPI_CS_PIN_NUMBER, 0); }
+void CS_unselect()	{ platform_gpio_write(NRF24L01_SPI_CS_PIN_PORT, NRF24L01_SPI_CS_PIN_NUMBER, 1); }
+void CE_enable()	{ platform_gpio_write(NRF24L01_CE_PIN_PORT, NRF24L01_CE_PIN_NUMBER, 1); }
+void CE_disable()	{ platform_gpio_write(NRF24L01_CE_PIN_PORT, NRF24L01_CE_PIN_NUMBER, 0); }
+
+void nrf24l01_bus_lock()	{ bus_lock++; }
+void nrf24l01_bus_unlock()	{ bus_lock--; }
+bool nrf24l01_bus_busy()	{ return bus_lock != 0; }
+
+
+// one CS cycle: command byte followed by length data bytes (NOP when tx_data is NULL)
+static uint8_t nrf24l01_spi_command(uint8_t cmd, const uint8_t *tx_data, uint8_t *rx_data, uint8_t length)
 {
-	uint8_t cmd = W_REGISTER | address;
-	uint8_t status;
-	uint8_t write_data = data;
+	uint8_t tx[NRF24L01_MAX_TRANSFER + 1];
+	uint8_t rx[NRF24L01_MAX_TRANSFER + 1];
+
+	if (length > NRF24L01_MAX_TRANSFER) length = NRF24L01_MAX_TRANSFER;
+	tx[0] = cmd;
+	if (tx_data)	memcpy(&tx[1], tx_data, length);
+	else			memset(&tx[1], NOP, length);
 
+	nrf24l01_bus_lock();
 	CS_select();
-	HAL_SPI_TransmitReceive(nrf24l01_SPI, &cmd, &status, 1, 1000);
-	HAL_SPI_Transmit(nrf24l01_SPI, &write_data, 1, 1000);
+	platform_spi_transfer(nrf24l01_SPI, tx, rx, length + 1, 1000);
 	CS_unselect();
+	nrf24l01_bus_unlock();
+
+	if (rx_data) memcpy(rx_data, &rx[1], length);
+
+	return rx[0];
+}
+
+// keep shadow copy when CONFIG, RF_SETUP or SETUP_RETR is written
+static void nrf24l01_update_shadow(uint8_t address, uint8_t data)
+{
+	switch (address & REGISTER_MASK)
+	{
+	case CONFIG:
+		shadow_config = data;
+		break;
+	case RF_SETUP:
+		shadow_rf_setup = data;
+		break;
+	case SETUP_RETR:
+		shadow_setup_retr = data;
+		break;
+	}
+}
+
+uint8_t nrf24l01_write_reg(uint8_t address, uint8_t data)
+{
+	nrf24l01_spi_command(W_REGISTER | address, &data, NULL, 1);
+	nrf24l01_update_shadow(address, data);
 
-	return write_data;
+	return data;
 }
+
 uint8_t nrf24l01_read_reg(uint8_t address)
 {
-	uint8_t cmd = R_REGISTER | address;
-	uint8_t status;
 	uint8_t read_data;
 
-	CS_select();
-	HAL_SPI_TransmitReceive(nrf24l01_SPI, &cmd, &status, 1, 1000);
-	HAL_SPI_Receive(nrf24l01_SPI, &read_data, 1, 100);
-	CS_unselect();
+	nrf24l01_spi_command(R_REGISTER | address, NULL, &read_data, 1);
 
 	return read_data;
 }
 
-void nrf24l01_reset()
+uint8_t nrf24l01_write_reg_multi(uint8_t address, const uint8_t *data, uint8_t length)
 {
-	CE_disable();
-
-	nrf24l01_write_reg(CONFIG, 0x08);
-	nrf24l01_write_reg(EN_AA, 0x3F);
-	nrf24l01_write_reg(EN_RXADDR, 0x03);
-	nrf24l01_write_reg(SETUP_AW, 0x03);
-	nrf24l01_write_reg(SETUP_RETR, 0x03);
-	nrf24l01_write_reg(RF_CH, 0x02);
-	nrf24l01_write_reg(RF_SETUP, 0x07);
-	nrf24l01_write_reg(STATUS, 0x0E);
-	nrf24l01_write_reg(OBSERVE_TX, 0x00);
-	nrf24l01_write_reg(RX_ADDR_P0, 0x00);
-	nrf24l01_write_reg(RX_ADDR_P1, 0x00);
-	nrf24l01_write_reg(RX_ADDR_P2, 0x00);
-	nrf24l01_write_reg(RX_ADDR_P3, 0x00);
-	nrf24l01_write_reg(RX_ADDR_P4, 0x00);
-	nrf24l01_write_reg(RX_ADDR_P5, 0x00);
-	nrf24l01_write_reg(FIFO_STATUS, 0x11);
-	nrf24l01_write_reg(DYNPD, 0x00);
-	nrf24l01_write_reg(FEATURE, 0x00);
-
-	nrf24l01_flush_rx_fifo();
-	nrf24l01_flush_tx_fifo();
+	uint8_t status = nrf24l01_spi_command(W_REGISTER | address, data, NULL, length);
+	nrf24l01_update_shadow(address, data[0]);
 
-	CE_enable();
+	return status;
 }
 
-void nrf24l01_rx_init(channel MHz, air_data_rate bps)
+uint8_t nrf24l01_read_reg_multi(uint8_t address, uint8_t *data, uint8_t length)
 {
-    nrf24l01_reset();
+	return nrf24l01_spi_command(R_REGISTER | address, NULL, data, length);
+}
 
-    CE_disable();
+// write whole register map in one sequence, CE must be low
+static void nrf24l01_load(uint8_t config, uint8_t rf_ch, uint8_t rf_setup, uint8_t setup_retr, uint8_t payload_width)
+{
+	static const uint8_t address_p0[5] = {0xE7, 0xE7, 0xE7, 0xE7, 0xE7};
+	static const uint8_t address_p1[5] = {0xC2, 0xC2, 0xC2, 0xC2, 0xC2};
+	const uint8_t reg_map[][2] =
+	{
+		{CONFIG,		config},
+		{EN_AA,			0x3F},
+		{EN_RXADDR,		0x03},
+		{SETUP_AW,		0x03},		// 5 bytes address
+		{SETUP_RETR,	setup_retr},
+		{RF_CH,			rf_ch},
+		{RF_SETUP,		rf_setup},
+		{STATUS,		0x70},		// clear RX_DR, TX_DS, MAX_RT
+		{RX_ADDR_P2,	0xC3},
+		{RX_ADDR_P3,	0xC4},
+		{RX_ADDR_P4,	0xC5},
+		{RX_ADDR_P5,	0xC6},
+		{RX_PW_P0,		payload_width},
+		{RX_PW_P1,		payload_width},
+		{RX_PW_P2,		0x00},
+		{RX_PW_P3,		0x00},
+		{RX_PW_P4,		0x00},
+		{RX_PW_P5,		0x00},
+		{DYNPD,			0x00},
+		{FEATURE,		0x00},
+	};
+
+	for (uint8_t i = 0; i < sizeof(reg_map) / sizeof(reg_map[0]); i++)
+	{
+		nrf24l01_write_reg(reg_map[i][0], reg_map[i][1]);
+	}
 
-    nrf24l01_prx_mode();
-    nrf24l01_power_up();
+	nrf24l01_write_reg_multi(RX_ADDR_P0, address_p0, 5);
+	nrf24l01_write_reg_multi(RX_ADDR_P1, address_p1, 5);
+	nrf24l01_write_reg_multi(TX_ADDR, address_p0, 5);
 
-    nrf24l01_rx_set_payload_widths(NRF24L01_PAYLOAD_LENGTH);
+	nrf24l01_flush_rx_fifo();
+	nrf24l01_flush_tx_fifo();
+}
 
-    nrf24l01_set_rf_channel(MHz);
-    nrf24l01_set_rf_air_data_rate(bps);
-    nrf24l01_set_rf_tx_output_power(_0dBm);
+static uint8_t nrf24l01_rf_dr_bits(air_data_rate bps)
+{
+	switch (bps)
+	{
+	case _250kbps:
+		return (1 << 5);	// RF_DR_LOW
+	case _2Mbps:
+		return (1 << 3);	// RF_DR_HIGH
+	default:
+		return 0;
+	}
+}
 
-    nrf24l01_set_crc_length(_1byte);
-    nrf24l01_set_address_widths(5);
+static void nrf24l01_init(uint8_t prim_rx, channel MHz, air_data_rate bps)
+{
+	CE_disable();
 
-    nrf24l01_auto_retransmit_count(3);
-    nrf24l01_auto_retransmit_delay(250);
+	// CONFIG: EN_CRC (1 byte), PWR_UP, PRIM_RX
+	nrf24l01_load(0x08 | (1 << 1) | prim_rx,
+				  MHz - MIN_FREQUENCY,
+				  nrf24l01_rf_dr_bits(bps) | (_0dBm << 1),
+				  ((NRF24L01_DEFAULT_ARD / 250 - 1) << 4) | NRF24L01_DEFAULT_ARC,
+				  NRF24L01_PAYLOAD_LENGTH);
 
-    CE_enable();
+	CE_enable();
 }
 
-void nrf24l01_tx_init(channel MHz, air_data_rate bps)
+void nrf24l01_reset()
 {
-    nrf24l01_reset();
-
-    CE_disable();
-
-    nrf24l01_ptx_mode();
-    nrf24l01_power_up();
+	CE_disable();
 
-    nrf24l01_set_rf_channel(MHz);
-    nrf24l01_set_rf_air_data_rate(bps);
-    nrf24l01_set_rf_tx_output_power(_0dBm);
+	nrf24l01_load(0x08, 0x02, 0x07, 0x03, 0x00);
 
-    nrf24l01_set_crc_length(_1byte);
-    nrf24l01_set_address_widths(5);
+	CE_enable();
+}
 
-    nrf24l01_auto_retransmit_count(3);
-    nrf24l01_auto_retransmit_delay(250);
+void nrf24l01_rx_init(channel MHz, air_data_rate bps)
+{
+    nrf24l01_init(1, MHz, bps);
+}
 
-    CE_enable();
+void nrf24l01_tx_init(channel MHz, air_data_rate bps)
+{
+    nrf24l01_init(0, MHz, bps);
 }
 
 void nrf24l01_rx_receive(uint8_t* rx_payload)
 {
     nrf24l01_read_rx_fifo(rx_payload);
+    link_stats.received++;
+    if (nrf24l01_get_rpd()) link_stats.rpd_high++;
     nrf24l01_clear_rx_dr();
     nrf24l01_flush_rx_fifo();
     // for testing
-    HAL_GPIO_TogglePin(GPIOC, GPIO_PIN_13);
+    platform_gpio_toggle(GPIOC, GPIO_PIN_13);
 }
 
 uint8_t nrf24l01_read_rx_fifo(uint8_t* rx_payload)
 {
-	uint8_t cmd = R_RX_PAYLOAD;
-	uint8_t status;
-
-	CS_unselect();
-	HAL_SPI_TransmitReceive(nrf24l01_SPI, &cmd, &status, 1, 1000);
-	HAL_SPI_Receive(nrf24l01_SPI, rx_payload, NRF24L01_PAYLOAD_LENGTH, 1000);
-	CS_select();
-
-	return status;
+	return nrf24l01_spi_command(R_RX_PAYLOAD, NULL, rx_payload, NRF24L01_PAYLOAD_LENGTH);
 }
 
 uint8_t nrf24l01_tx_transmit(uint8_t* tx_payload)
 {
     nrf24l01_write_tx_fifo(tx_payload);
+    link_stats.sent++;
+    link_stats.tx_time = platform_micros();
 
     uint8_t fifo_status = nrf24l01_read_reg(FIFO_STATUS);
 
@@ -152,89 +215,89 @@ uint8_t nrf24l01_tx_transmit(uint8_t* tx_payload)
 	return 0;
 }
 
-uint8_t nrf24l01_write_tx_fifo(uint8_t* tx_payload)
+uint8_t nrf24l01_tx_irq()
 {
-	uint8_t cmd = W_TX_PAYLOAD;
-	uint8_t status;
+	uint8_t status = nrf24l01_get_status();
+	uint8_t acked = 0;
 
-	CS_unselect();
-	HAL_SPI_TransmitReceive(nrf24l01_SPI, &cmd, &status, 1, 1000);
-	HAL_SPI_Transmit(nrf24l01_SPI, tx_payload, NRF24L01_PAYLOAD_LENGTH, 1000);
-	CS_select();
+	if (status & 0x20) // TX_DS
+	{
+		link_stats.acked++;
+		acked = 1;
+		nrf24l01_clear_tx_ds();
+	}
+	else if (status & 0x10) // MAX_RT, payload stays in TX FIFO
+	{
+		link_stats.lost++;
+		nrf24l01_clear_max_rt();
+		nrf24l01_flush_tx_fifo();
+	}
+	else
+	{
+		return 0;
+	}
 
-	return status;
-}
+	uint8_t observe_tx = nrf24l01_get_observe_tx();
+	link_stats.plos_cnt = observe_tx >> 4;
+	link_stats.arc_cnt = observe_tx & 0x0F;
+	link_stats.retransmits += link_stats.arc_cnt;
 
-void nrf24l01_flush_rx_fifo()
-{
-	uint8_t cmd = FLUSH_RX;
-	uint8_t status;
+	link_stats.latency_last = platform_micros() - link_stats.tx_time;
+	link_stats.latency_sum += link_stats.latency_last;
+	if (link_stats.latency_last > link_stats.latency_max)
+	{
+		link_stats.latency_max = link_stats.latency_last;
+	}
 
-	CS_unselect();
-	HAL_SPI_TransmitReceive(nrf24l01_SPI, &cmd, &status, 1, 1000);
-	CS_select();
+	return acked;
 }
 
-void nrf24l01_flush_tx_fifo()
+uint8_t nrf24l01_write_tx_fifo(uint8_t* tx_payload)
 {
-	uint8_t cmd = FLUSH_TX;
-	uint8_t status;
-
-	CS_unselect();
-	HAL_SPI_TransmitReceive(nrf24l01_SPI, &cmd, &status, 1, 1000);
-	CS_select();
+	return nrf24l01_spi_command(W_TX_PAYLOAD, tx_payload, NULL, NRF24L01_PAYLOAD_LENGTH);
 }
 
-void nrf24l01_clear_rx_dr()
-{
-	uint8_t new_status = nrf24l01_get_status();
-
-	new_status |= 0x40; //set RX_DR to 1 for clear bit
-	nrf24l01_write_reg(STATUS, new_status);
-}
+void nrf24l01_flush_rx_fifo()	{	nrf24l01_spi_command(FLUSH_RX, NULL, NULL, 0);	}
 
-void nrf24l01_clear_tx_ds()
-{
-	uint8_t new_status = nrf24l01_get_status();
+void nrf24l01_flush_tx_fifo()	{	nrf24l01_spi_command(FLUSH_TX, NULL, NULL, 0);	}
 
-	new_status |= 0x20; //set TX_DS to 1 for clear bit
-	nrf24l01_write_reg(STATUS, new_status);
-}
+// write 1 to clear, other flags are written 0 so they are kept
+void nrf24l01_clear_rx_dr()		{	nrf24l01_write_reg(STATUS, 0x40);	}
 
-void nrf24l01_clear_max_rt()
-{
-	uint8_t new_status = nrf24l01_get_status();
+void nrf24l01_clear_tx_ds()		{	nrf24l01_write_reg(STATUS, 0x20);	}
 
-	new_status |= 0x10; //set MAX_RT to 1 for clear bit
-	nrf24l01_write_reg(STATUS, new_status);
-}
+void nrf24l01_clear_max_rt()	{	nrf24l01_write_reg(STATUS, 0x10);	}
 
 void nrf24l01_ptx_mode()
 {
-	uint8_t new_config = nrf24l01_read_reg(CONFIG);
-	new_config &= 0xFE; 	// set last bit is 0
-	nrf24l01_write_reg(CONFIG, new_config);
+	nrf24l01_write_reg(CONFIG, shadow_config & 0xFE); 	// set last bit is 0
 }
 
 void nrf24l01_prx_mode()
 {
-	uint8_t new_config = nrf24l01_read_reg(CONFIG);
-	new_config |= 1; 	// set last bit is 1
-	nrf24l01_write_reg(CONFIG, new_config);
+	nrf24l01_write_reg(CONFIG, shadow_config | 1); 	// set last bit is 1
+}
+
+void nrf24l01_switch_role(nrf24l01_role role)
+{
+	nrf24l01_bus_lock();
+	CE_disable();
+
+	if (role == PRX)	nrf24l01_prx_mode();
+	else				nrf24l01_ptx_mode();
+
+	CE_enable();
+	nrf24l01_bus_unlock();
 }
 
 void nrf24l01_power_up()
 {
-	uint8_t new_config = nrf24l01_read_reg(CONFIG);
-	new_config |= (1 << 1); 	// set second bit is 1
-	nrf24l01_write_reg(CONFIG, new_config);
+	nrf24l01_write_reg(CONFIG, shadow_config | (1 << 1)); 	// set second bit is 1
 }
 
 void nrf24l01_power_down()
 {
-	uint8_t new_config = nrf24l01_read_reg(CONFIG);
-	new_config &= 0xFD; 	// set second bit is 0
-	nrf24l01_write_reg(CONFIG, new_config);
+	nrf24l01_write_reg(CONFIG, shadow_config & 0xFD); 	// set second bit is 0
 }
 
 void nrf24l01_set_rf_channel(channel MHz)
@@ -244,42 +307,25 @@ void nrf24l01_set_rf_channel(channel MHz)
 
 void nrf24l01_set_rf_air_data_rate(air_data_rate bps)
 {
-	uint8_t new_rf_air_rate = nrf24l01_read_reg(RF_SETUP) & 0xD7; // & 8b1101_0111 (set RF_DR_LOW and RF_DR_HIGH to 0)
-
-	switch (bps)
-	{
-	case _250kbps:
-		new_rf_air_rate |= (1 << 3);
-		break;
-	case _1Mbps:
-		new_rf_air_rate |= 0;
-		break;
-	case _2Mbps:
-		new_rf_air_rate |= (1 << 5);
-		break;
-	}
-
-	nrf24l01_write_reg(RF_SETUP, new_rf_air_rate);
+	// & 8b1101_0111 (set RF_DR_LOW and RF_DR_HIGH to 0)
+	nrf24l01_write_reg(RF_SETUP, (shadow_rf_setup & 0xD7) | nrf24l01_rf_dr_bits(bps));
 }
 
 void nrf24l01_set_rf_tx_output_power(output_power dBm)
 {
-	uint8_t new_rf_output_power = nrf24l01_read_reg(RF_SETUP) & 0xF9; // & 8b1101_0111 (set PWR to 00)
-	new_rf_output_power |= (1 << dBm);
-	nrf24l01_write_reg(RF_SETUP, new_rf_output_power);
+	// & 8b1111_1001 (set RF_PWR to 00)
+	nrf24l01_write_reg(RF_SETUP, (shadow_rf_setup & 0xF9) | (dBm << 1));
 }
 
 void nrf24l01_set_crc_length(crc_length bytes)
 {
-	uint8_t new_crc_length = nrf24l01_read_reg(CONFIG);
-
 	switch (bytes)
 	{
 	case _1byte:
-		new_crc_length &= 0xFB;
+		nrf24l01_write_reg(CONFIG, shadow_config & 0xFB);
 		break;
 	case _2byte:
-		new_crc_length |= 0x04;
+		nrf24l01_write_reg(CONFIG, shadow_config | 0x04);
 		break;
 	}
 }
@@ -289,44 +335,122 @@ void nrf24l01_set_address_widths(widths bytes)
 	nrf24l01_write_reg(SETUP_AW, bytes - 2);
 }
 
-uint8_t nrf24l01_get_status()
+void nrf24l01_set_tx_address(const uint8_t *address)
 {
-	uint8_t cmd = nrf24l01_read_reg(NOP);
-
-	uint8_t status;
-
-	CS_select();
-	HAL_SPI_TransmitReceive(nrf24l01_SPI, &cmd, &status, 1, 1000);
-	CS_unselect();
+	nrf24l01_write_reg_multi(TX_ADDR, address, 5);
+	// pipe 0 receives auto acknowledgement
+	nrf24l01_write_reg_multi(RX_ADDR_P0, address, 5);
+}
 
-	return status;
+void nrf24l01_set_rx_address(uint8_t pipe, const uint8_t *address)
+{
+	// pipe 2 - 5 only have the LSByte, others are shared with pipe 1
+	nrf24l01_write_reg_multi(RX_ADDR_P0 + pipe, address, (pipe < 2) ? 5 : 1);
 }
 
+uint8_t nrf24l01_get_status()	{	return nrf24l01_spi_command(NOP, NULL, NULL, 0);	}
+
 uint8_t nrf24l01_get_fifo_status()	{	return nrf24l01_read_reg(FIFO_STATUS);	}
 
 void nrf24l01_rx_set_payload_widths(widths bytes)
 {
 	// pipe 0 and 1 are selected by default
-	nrf24l01_write_reg(RX_ADDR_P0, bytes);
+	nrf24l01_write_reg(RX_PW_P0, bytes);
+	nrf24l01_write_reg(RX_PW_P1, bytes);
 }
 
 void nrf24l01_auto_retransmit_count(count cnt)
 {
-	uint8_t new_config = nrf24l01_read_reg(SETUP_RETR);
-
-	new_config &= 0xF0; // set ARC to 0000
-	new_config |= cnt; // set ARC
-
-	nrf24l01_write_reg(SETUP_RETR, new_config);
+	// set ARC
+	nrf24l01_write_reg(SETUP_RETR, (shadow_setup_retr & 0xF0) | (cnt & 0x0F));
 }
 
 void nrf24l01_auto_retransmit_delay(delay us)
 {
-	uint8_t new_config = nrf24l01_read_reg(SETUP_RETR);
+	// set ARD
+	nrf24l01_write_reg(SETUP_RETR, (shadow_setup_retr & 0x0F) | ((us / 250 - 1) << 4));
+}
 
-	new_config &= 0x0F; // set ARD to 0000
-	new_config |= ((us / 250 - 1) << 4); // set ARD
+void nrf24l01_get_link_stats(nrf24l01_link_stats *stats)	{	*stats = link_stats;	}
 
-	nrf24l01_write_reg(SETUP_RETR, new_config);
+void nrf24l01_reset_link_stats()	{	memset(&link_stats, 0, sizeof(link_stats));	}
+
+uint8_t nrf24l01_get_observe_tx()	{	return nrf24l01_read_reg(OBSERVE_TX);	}
+
+uint8_t nrf24l01_get_rpd()	{	return nrf24l01_read_reg(CD) & 0x01;	}
+
+void nrf24l01_adapt_init(nrf24l01_adaptive *policy, air_data_rate bps)
+{
+	policy->arc = shadow_setup_retr & 0x0F;
+	policy->ard = ((shadow_setup_retr >> 4) + 1) * 250;
+	policy->bps = bps;
+	policy->sent = link_stats.sent;
+	policy->lost = link_stats.lost;
+	policy->retransmits = link_stats.retransmits;
+	policy->clean_windows = 0;
 }
 
+uint8_t nrf24l01_adapt_link(nrf24l01_adaptive *policy)
+{
+	uint32_t sent = link_stats.sent - policy->sent;
+	if (sent < NRF24L01_ADAPT_WINDOW) return 0;
+
+	uint32_t loss = (link_stats.lost - policy->lost) * 100 / sent;
+	uint32_t retry = (link_stats.retransmits - policy->retransmits) * 100 / sent;
+
+	count arc = policy->arc;
+	delay ard = policy->ard;
+	air_data_rate bps = policy->bps;
+
+	if (loss >= NRF24L01_ADAPT_LOSS_HIGH)
+	{
+		// noisy channel: retry more, then wait longer, then slow down the air data rate
+		policy->clean_windows = 0;
+		if (arc < 15)				arc = (arc + 3 > 15) ? 15 : arc + 3;
+		else if (ard < 1500)		ard += 250;
+		else if (bps == _2Mbps)		bps = _1Mbps;
+		else if (bps == _1Mbps)		bps = _250kbps;
+	}
+	else if (loss == 0 && retry <= NRF24L01_ADAPT_RETRY_LOW)
+	{
+		// clean channel: stop wasting airtime, then speed up the air data rate
+		if (policy->clean_windows < NRF24L01_ADAPT_CLEAN_WINDOWS) policy->clean_windows++;
+
+		if (ard > 250)				ard -= 250;
+		else if (arc > NRF24L01_DEFAULT_ARC) arc--;
+		else if (policy->clean_windows >= NRF24L01_ADAPT_CLEAN_WINDOWS)
+		{
+			if (bps == _250kbps)	bps = _1Mbps;
+			else if (bps == _1Mbps)	bps = _2Mbps;
+			policy->clean_windows = 0;
+		}
+	}
+	else
+	{
+		policy->clean_windows = 0;
+	}
+
+	// ACK packet needs at least 500us at 250kbps
+	if (bps == _250kbps && ard < 500) ard = 500;
+
+	uint8_t changed = (arc != policy->arc) || (ard != policy->ard) || (bps != policy->bps);
+
+	if (changed)
+	{
+		CE_disable();
+		if (arc != policy->arc) nrf24l01_auto_retransmit_count(arc);
+		if (ard != policy->ard) nrf24l01_auto_retransmit_delay(ard);
+		if (bps != policy->bps) nrf24l01_set_rf_air_data_rate(bps);
+		CE_enable();
+
+		policy->arc = arc;
+		policy->ard = ard;
+		policy->bps = bps;
+	}
+
+	policy->sent = link_stats.sent;
+	policy->lost = link_stats.lost;
+	policy->retransmits = link_stats.retransmits;
+
+	return changed;
+}
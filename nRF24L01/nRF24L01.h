@@ -8,12 +8,12 @@
 #ifndef SRC_NRF21L01_H_
 #define SRC_NRF21L01_H_
 
-#include "main.h"
+#include "../Platform/platform.h"
 #include "string.h"
 #include <stdbool.h>
 
 /* User Configurations */
-extern SPI_HandleTypeDef 				          hspi1;
+extern platform_spi 				              hspi1;
 #define nrf24l01_SPI                     (&hspi1)
 
 #define NRF24L01_SPI_CS_PIN_PORT         GPIOB
@@ -25,11 +25,23 @@ extern SPI_HandleTypeDef 				          hspi1;
 #define NRF24L01_IRQ_PIN_PORT            GPIOA
 #define NRF24L01_IRQ_PIN_NUMBER          GPIO_PIN_8
 
+#ifndef NRF24L01_PAYLOAD_LENGTH
 #define NRF24L01_PAYLOAD_LENGTH          8     // 1 - 32bytes
+#endif
+
+#define NRF24L01_DEFAULT_ARC             3     // 0 - 15 retransmits
+#define NRF24L01_DEFAULT_ARD             250   // 250 - 4000us
+
+// adaptive link policy (see nrf24l01_adapt_link)
+#define NRF24L01_ADAPT_WINDOW            32    // packets per evaluation window
+#define NRF24L01_ADAPT_LOSS_HIGH         10    // % lost -> more robust settings
+#define NRF24L01_ADAPT_RETRY_LOW         25    // retransmits per 100 packets -> cheaper settings
+#define NRF24L01_ADAPT_CLEAN_WINDOWS     4     // clean windows before stepping air data rate up
 /* End User Configurations */
 
 /* nRF24L01+ typedefs */
 #define MIN_FREQUENCY 2400
+#define NRF24L01_MAX_TRANSFER 32 // payload or register bytes per command
 typedef uint8_t count;
 typedef uint8_t widths;
 typedef uint16_t delay;
@@ -55,6 +67,41 @@ typedef enum
 	_1byte = 0,
 	_2byte = 1
 } crc_length;
+
+typedef enum
+{
+	PTX = 0,
+	PRX = 1
+} nrf24l01_role;
+
+#define NRF24L01_SETTLING_US	130		// Tstby2a, standby -> TX/RX mode
+
+typedef struct
+{
+	uint32_t sent;				// payloads written into TX FIFO
+	uint32_t acked;				// TX_DS (auto acknowledged)
+	uint32_t lost;				// MAX_RT (retransmit count exhausted)
+	uint32_t retransmits;		// sum of ARC_CNT of every finished packet
+	uint8_t  plos_cnt;			// last PLOS_CNT (lost packets on this channel, max 15)
+	uint8_t  arc_cnt;			// last ARC_CNT (retransmits of last packet)
+	uint32_t received;			// payloads read from RX FIFO
+	uint32_t rpd_high;			// received payloads with RPD set (signal > -64dBm)
+	uint32_t latency_last;		// us from write TX FIFO to TX_DS/MAX_RT
+	uint32_t latency_max;		// us
+	uint64_t latency_sum;		// us, divide by (acked + lost) for mean
+	uint32_t tx_time;			// platform_micros of last transmit
+} nrf24l01_link_stats;
+
+typedef struct
+{
+	count arc;					// current auto retransmit count
+	delay ard;					// current auto retransmit delay (us)
+	air_data_rate bps;			// current air data rate
+	uint32_t sent;				// stats snapshot at start of window
+	uint32_t lost;
+	uint32_t retransmits;
+	uint8_t clean_windows;		// consecutive windows without loss
+} nrf24l01_adaptive;
 /* FUNCTION PART */
 
 /* Main Functions */
@@ -88,10 +135,54 @@ void nrf24l01_rx_receive(uint8_t* rx_payload);
 uint8_t nrf24l01_tx_transmit(uint8_t* tx_payload);
 
 /**
-  * @brief  Check tx_ds or max_rt (used for retransmit)
+  * @brief  Check tx_ds or max_rt (used for retransmit) and update link statistics
+  * @param  Null
+  * @return 1 if payload is acknowledged, 0 if it is lost or nothing happened
+*/
+uint8_t nrf24l01_tx_irq();
+
+/* Link Quality */
+/**
+  * @brief  Copy current link statistics
+  * @param  stats is pointer to the structure which receives the statistics
+*/
+void nrf24l01_get_link_stats(nrf24l01_link_stats *stats);
+
+/**
+  * @brief  Clear all link statistics
+  * @param  Null
+*/
+void nrf24l01_reset_link_stats();
+
+/**
+  * @brief  Read OBSERVE_TX register
   * @param  Null
+  * @return PLOS_CNT (bit 7:4) and ARC_CNT (bit 3:0)
+*/
+uint8_t nrf24l01_get_observe_tx();
+
+/**
+  * @brief  Received Power Detector (only valid in PRX mode)
+  * @param  Null
+  * @return 1 if received power is higher than -64dBm
+*/
+uint8_t nrf24l01_get_rpd();
+
+/**
+  * @brief  Start adaptive retransmit/air data rate policy from current settings
+  * @param  policy is pointer to the adaptive policy structure
+  * @param  bps is air data rate used in tx init
+*/
+void nrf24l01_adapt_init(nrf24l01_adaptive *policy, air_data_rate bps);
+
+/**
+  * @brief  Tune ARC/ARD and air data rate from loss observed since last window
+  *         (call after nrf24l01_tx_irq, does nothing until NRF24L01_ADAPT_WINDOW packets are sent)
+  *         Both ends must use the same air data rate, so only call it when the receiver follows
+  * @param  policy is pointer to the adaptive policy structure
+  * @return 1 if any setting is changed
 */
-void nrf24l01_tx_irq();
+uint8_t nrf24l01_adapt_link(nrf24l01_adaptive *policy);
 
 
 /* Sub Functions */
@@ -115,6 +206,13 @@ void nrf24l01_prx_mode();
 */
 void nrf24l01_ptx_mode();
 
+/**
+  * @brief  Switch between PTX and PRX without reset (only PRIM_RX and CE are touched)
+  *         Radio is ready NRF24L01_SETTLING_US after return, wait for it with a timer
+  * @param  role is new role
+*/
+void nrf24l01_switch_role(nrf24l01_role role);
+
 /**
   * @brief  Power up the device
   * @param  Null
@@ -254,6 +352,37 @@ uint8_t nrf24l01_write_reg(uint8_t address, uint8_t data);
 */
 uint8_t nrf24l01_read_reg(uint8_t address);
 
+/**
+  * @brief  write multi bytes into register in one CS cycle (e.g. 5 bytes address)
+  * @param  address is address of register
+  * @param 	data is written data (LSByte first)
+  * @param 	length is number of bytes (1 - 32, more is cut to NRF24L01_MAX_TRANSFER)
+  * @return status
+*/
+uint8_t nrf24l01_write_reg_multi(uint8_t address, const uint8_t *data, uint8_t length);
+
+/**
+  * @brief  read multi bytes from register in one CS cycle
+  * @param  address is address of register
+  * @param 	data is read data (LSByte first)
+  * @param 	length is number of bytes (1 - 32, more is cut to NRF24L01_MAX_TRANSFER)
+  * @return status
+*/
+uint8_t nrf24l01_read_reg_multi(uint8_t address, uint8_t *data, uint8_t length);
+
+/**
+  * @brief  Set Tx address (also RX_ADDR_P0 for auto acknowledgement)
+  * @param  address is 5 bytes address (LSByte first)
+*/
+void nrf24l01_set_tx_address(const uint8_t *address);
+
+/**
+  * @brief  Set Rx address of a pipe
+  * @param  pipe is 0 - 5
+  * @param  address is 5 bytes address for pipe 0, 1 and 1 byte (LSByte) for pipe 2 - 5
+*/
+void nrf24l01_set_rx_address(uint8_t pipe, const uint8_t *address);
+
 /**
   * @brief  Set low for CS pin
   * @param  Null
@@ -278,6 +407,26 @@ void CE_enable();
 */
 void CE_disable();
 
+/**
+  * @brief  Hold the SPI bus over a sequence of commands (nests, every SPI command takes it too)
+  *         main loop code the hop or slot interrupts must not split can be put inside
+  * @param  Null
+*/
+void nrf24l01_bus_lock();
+
+/**
+  * @brief  Release the SPI bus taken by nrf24l01_bus_lock
+  * @param  Null
+*/
+void nrf24l01_bus_unlock();
+
+/**
+  * @brief  Check if the SPI bus is held, an interrupt handler must defer its commands then
+  *         (single core: whatever it preempted resumes only after the handler returns)
+  * @return true while a command or a locked sequence is in progress
+*/
+bool nrf24l01_bus_busy();
+
 /* END FUNCTION PART */
 
 
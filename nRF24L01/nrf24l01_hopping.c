@@ -0,0 +1,160 @@
+/*
+ * nrf24l01_hopping.c
+ *
+ *  Frequency hopping scheduler for nRF24L01+
+ */
+
+#include "nrf24l01_hopping.h"
+
+// xorshift32, same sequence on both ends for the same seed
+static uint32_t hop_random(uint32_t *state)
+{
+	uint32_t x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+// locked: a tick in the middle defers instead of writing a newer channel before this one
+static void hop_set_channel(nrf24l01_hopping *hop)
+{
+	nrf24l01_bus_lock();
+	CE_disable();
+	nrf24l01_set_rf_channel(MIN_FREQUENCY + hop->sequence[hop->index]);
+	CE_enable();
+	nrf24l01_bus_unlock();
+}
+
+void nrf24l01_hop_init(nrf24l01_hopping *hop, platform_timer *htim, uint32_t seed)
+{
+	hop->htim = htim;
+	hop->seed = seed ? seed : 1; // xorshift never leaves 0
+	hop->index = 0;
+	hop->pending = false;
+	memset(hop->blacklist, 0, sizeof(hop->blacklist));
+	nrf24l01_hop_build_sequence(hop);
+}
+
+bool nrf24l01_hop_is_blacklisted(nrf24l01_hopping *hop, uint8_t rf_ch)
+{
+	return hop->blacklist[rf_ch >> 3] & (1 << (rf_ch & 0x07));
+}
+
+uint8_t nrf24l01_hop_scan(nrf24l01_hopping *hop)
+{
+	uint8_t busy = 0;
+
+	memset(hop->blacklist, 0, sizeof(hop->blacklist));
+
+	for (uint8_t rf_ch = 0; rf_ch < NRF24L01_CHANNELS; rf_ch++)
+	{
+		uint8_t hits = 0;
+
+		CE_disable();
+		nrf24l01_set_rf_channel(MIN_FREQUENCY + rf_ch);
+		CE_enable();
+
+		for (uint8_t i = 0; i < NRF24L01_HOP_SCAN_SAMPLES; i++)
+		{
+			platform_delay_ms(1); // > 130us RX settling + 40us RPD
+			hits += nrf24l01_get_rpd();
+		}
+
+		if (hits >= NRF24L01_HOP_BUSY_THRESHOLD)
+		{
+			hop->blacklist[rf_ch >> 3] |= (1 << (rf_ch & 0x07));
+			busy++;
+		}
+	}
+
+	nrf24l01_hop_build_sequence(hop);
+	hop_set_channel(hop);
+
+	return busy;
+}
+
+void nrf24l01_hop_set_blacklist(nrf24l01_hopping *hop, const uint8_t *blacklist)
+{
+	memcpy(hop->blacklist, blacklist, sizeof(hop->blacklist));
+	nrf24l01_hop_build_sequence(hop);
+}
+
+void nrf24l01_hop_build_sequence(nrf24l01_hopping *hop)
+{
+	uint8_t free_channels[NRF24L01_CHANNELS];
+	uint8_t nums = 0;
+	uint32_t state = hop->seed;
+
+	for (uint8_t rf_ch = 0; rf_ch < NRF24L01_CHANNELS; rf_ch++)
+	{
+		if (!nrf24l01_hop_is_blacklisted(hop, rf_ch)) free_channels[nums++] = rf_ch;
+	}
+
+	// whole band is busy, hop over it anyway
+	if (nums == 0)
+	{
+		for (uint8_t rf_ch = 0; rf_ch < NRF24L01_CHANNELS; rf_ch++) free_channels[nums++] = rf_ch;
+	}
+
+	// partial Fisher-Yates shuffle, only first NRF24L01_HOP_LENGTH are needed
+	hop->length = (nums < NRF24L01_HOP_LENGTH) ? nums : NRF24L01_HOP_LENGTH;
+	for (uint8_t i = 0; i < hop->length; i++)
+	{
+		uint8_t j = i + hop_random(&state) % (nums - i);
+		uint8_t temp = free_channels[i];
+		free_channels[i] = free_channels[j];
+		free_channels[j] = temp;
+		hop->sequence[i] = free_channels[i];
+	}
+
+	if (hop->index >= hop->length) hop->index = 0;
+}
+
+void nrf24l01_hop_start(nrf24l01_hopping *hop)
+{
+	hop->index = 0;
+	hop->pending = false;
+	hop_set_channel(hop);
+	platform_timer_set_counter(hop->htim, 0);
+	platform_timer_start_it(hop->htim);
+}
+
+void nrf24l01_hop_stop(nrf24l01_hopping *hop)
+{
+	platform_timer_stop_it(hop->htim);
+}
+
+void nrf24l01_hop_tick(nrf24l01_hopping *hop)
+{
+	hop->index = (hop->index + 1) % hop->length;
+
+	// CS of a main loop command is low: a register write now would join its transfer
+	if (nrf24l01_bus_busy())
+	{
+		hop->pending = true;
+		return;
+	}
+	hop->pending = false;
+	hop_set_channel(hop);
+}
+
+void nrf24l01_hop_process(nrf24l01_hopping *hop)
+{
+	if (!hop->pending) return;
+
+	hop->pending = false;
+	hop_set_channel(hop);
+}
+
+void nrf24l01_hop_sync(nrf24l01_hopping *hop, uint8_t index)
+{
+	platform_timer_set_counter(hop->htim, 0);
+	if (index != hop->index || hop->pending)
+	{
+		hop->index = index % hop->length;
+		hop->pending = false;
+		hop_set_channel(hop);
+	}
+}
@@ -0,0 +1,106 @@
+/*
+ * nrf24l01_hopping.h
+ *
+ *  Frequency hopping scheduler for nRF24L01+
+ *  Both ends build the same hop sequence from a shared seed and blacklist,
+ *  and a hardware timer moves them to the next channel in lockstep.
+ *  A hop that comes while the main loop holds the SPI bus (nrf24l01_bus_busy) is
+ *  not written from the interrupt: call nrf24l01_hop_process after radio calls in main loop.
+ */
+
+#ifndef SRC_NRF24L01_HOPPING_H_
+#define SRC_NRF24L01_HOPPING_H_
+
+#include "nRF24L01.h"
+
+/* User Configurations */
+#define NRF24L01_HOP_LENGTH             16    // channels per hop sequence
+#define NRF24L01_HOP_SCAN_SAMPLES       20    // RPD samples per channel
+#define NRF24L01_HOP_BUSY_THRESHOLD     2     // RPD hits to blacklist a channel
+/* End User Configurations */
+
+#define NRF24L01_CHANNELS               126   // 2400MHz - 2525MHz
+#define NRF24L01_BLACKLIST_BYTES        ((NRF24L01_CHANNELS + 7) / 8)
+
+typedef struct
+{
+	uint8_t sequence[NRF24L01_HOP_LENGTH];	// RF_CH of each hop
+	uint8_t length;							// valid hops in sequence
+	volatile uint8_t index;					// current hop
+	volatile bool pending;					// index moved, radio not retuned yet
+	uint32_t seed;							// shared by both ends
+	uint8_t blacklist[NRF24L01_BLACKLIST_BYTES]; // 1 bit per channel
+	platform_timer *htim;				// timer of hop period
+} nrf24l01_hopping;
+
+/**
+  * @brief  Init hopping scheduler (empty blacklist)
+  * @param  *hop is pointer to the hopping structure
+  * @param  *htim is timer whose update interrupt is the hop period (same period on both ends)
+  * @param  seed is shared seed of hop sequence
+*/
+void nrf24l01_hop_init(nrf24l01_hopping *hop, platform_timer *htim, uint32_t seed);
+
+/**
+  * @brief  Scan 2400 - 2525MHz with RPD and blacklist busy channels (call after nrf24l01_rx_init)
+  *         Takes about NRF24L01_CHANNELS * NRF24L01_HOP_SCAN_SAMPLES ms
+  * @param  *hop is pointer to the hopping structure
+  * @return number of blacklisted channels
+*/
+uint8_t nrf24l01_hop_scan(nrf24l01_hopping *hop);
+
+/**
+  * @brief  Copy blacklist from the other end (e.g. received in a payload) and rebuild sequence
+  * @param  *hop is pointer to the hopping structure
+  * @param  *blacklist is NRF24L01_BLACKLIST_BYTES bytes bitmap
+*/
+void nrf24l01_hop_set_blacklist(nrf24l01_hopping *hop, const uint8_t *blacklist);
+
+/**
+  * @brief  Build hop sequence from seed and blacklist
+  * @param  *hop is pointer to the hopping structure
+*/
+void nrf24l01_hop_build_sequence(nrf24l01_hopping *hop);
+
+/**
+  * @brief  Go to first hop and start hop timer
+  * @param  *hop is pointer to the hopping structure
+*/
+void nrf24l01_hop_start(nrf24l01_hopping *hop);
+
+/**
+  * @brief  Stop hop timer (radio stays on current channel)
+  * @param  *hop is pointer to the hopping structure
+*/
+void nrf24l01_hop_stop(nrf24l01_hopping *hop);
+
+/**
+  * @brief  Move to next channel (deferred to nrf24l01_hop_process if the SPI bus is busy)
+  *         throw into HAL_TIM_PeriodElapsedCallback when htim is hop timer
+  * @param  *hop is pointer to the hopping structure
+*/
+void nrf24l01_hop_tick(nrf24l01_hopping *hop);
+
+/**
+  * @brief  Retune to the current hop if nrf24l01_hop_tick had to defer it
+  *         call in main loop after each radio access (e.g. nrf24l01_tx_transmit)
+  * @param  *hop is pointer to the hopping structure
+*/
+void nrf24l01_hop_process(nrf24l01_hopping *hop);
+
+/**
+  * @brief  Re-align with the other end (e.g. hop index carried in received payload)
+  *         and restart hop period from now
+  * @param  *hop is pointer to the hopping structure
+  * @param  index is hop index of the other end
+*/
+void nrf24l01_hop_sync(nrf24l01_hopping *hop, uint8_t index);
+
+/**
+  * @brief  Check if channel is blacklisted
+  * @param  *hop is pointer to the hopping structure
+  * @param  rf_ch is channel (0 - 125)
+*/
+bool nrf24l01_hop_is_blacklisted(nrf24l01_hopping *hop, uint8_t rf_ch);
+
+#endif /* SRC_NRF24L01_HOPPING_H_ */
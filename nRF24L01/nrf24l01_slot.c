@@ -0,0 +1,265 @@
+/*
+ * nrf24l01_slot.c
+ *
+ *  Time-slotted request/response over one half-duplex nRF24L01+ link
+ */
+
+#include "nrf24l01_slot.h"
+
+// one shot of us microseconds on 1us tick timer
+static void one_shot_start(platform_timer *htim, uint16_t us)
+{
+	platform_timer_stop_it(htim);
+	platform_timer_set_period(htim, us - 1);
+	platform_timer_set_counter(htim, 0);
+	platform_timer_clear_update(htim);
+	platform_timer_start_it(htim);
+}
+
+static void slot_timer_start(nrf24l01_station *station, uint16_t us)
+{
+	one_shot_start(station->htim, us);
+}
+
+static void slot_begin(nrf24l01_station *station)
+{
+	nrf24l01_set_tx_address(station->address[station->node]);
+	nrf24l01_flush_rx_fifo();
+	nrf24l01_switch_role(PTX);
+	station->state = SLOT_SETTLING_TX;
+	slot_timer_start(station, NRF24L01_SETTLING_US);
+}
+
+static void slot_end(nrf24l01_station *station, uint8_t *response)
+{
+	platform_timer_stop_it(station->htim);
+	nrf24l01_station_callback(station->node, response);
+
+	if (station->state == SLOT_IDLE) return; // stopped
+
+	station->node = (station->node + 1) % station->nums_of_node;
+	slot_begin(station);
+}
+
+void nrf24l01_station_init(nrf24l01_station *station, platform_timer *htim, uint16_t window_us)
+{
+	station->htim = htim;
+	station->nums_of_node = 0;
+	station->node = 0;
+	station->window_us = window_us;
+	station->state = SLOT_IDLE;
+	station->irq_pending = false;
+	station->responses = 0;
+	station->timeouts = 0;
+	station->lost = 0;
+	memset(station->request, 0, sizeof(station->request));
+	memset(station->response, 0, sizeof(station->response));
+}
+
+uint8_t nrf24l01_station_add_node(nrf24l01_station *station, const uint8_t *address)
+{
+	if (station->nums_of_node >= NRF24L01_MAX_NODE) return 0xFF;
+
+	memcpy(station->address[station->nums_of_node], address, 5);
+	return station->nums_of_node++;
+}
+
+void nrf24l01_station_start(nrf24l01_station *station)
+{
+	if (station->nums_of_node == 0) return;
+
+	station->node = 0;
+	nrf24l01_bus_lock();
+	slot_begin(station);
+	nrf24l01_bus_unlock();
+}
+
+void nrf24l01_station_stop(nrf24l01_station *station)
+{
+	station->state = SLOT_IDLE;
+}
+
+static void station_timer(nrf24l01_station *station)
+{
+	switch (station->state)
+	{
+	case SLOT_SETTLING_TX:
+		// request goes on air, its outcome comes from IRQ pin
+		nrf24l01_write_tx_fifo(station->request);
+		station->state = SLOT_TX_WAIT;
+		slot_timer_start(station, station->window_us);
+		break;
+	case SLOT_SETTLING_RX:
+		station->state = SLOT_RX_WAIT;
+		slot_timer_start(station, station->window_us);
+		break;
+	case SLOT_TX_WAIT:
+	case SLOT_RX_WAIT:
+		station->timeouts++;
+		nrf24l01_flush_tx_fifo();
+		slot_end(station, NULL);
+		break;
+	default:
+		platform_timer_stop_it(station->htim);
+		break;
+	}
+}
+
+static void station_irq(nrf24l01_station *station)
+{
+	uint8_t status = nrf24l01_get_status();
+
+	if (station->state == SLOT_TX_WAIT)
+	{
+		if (status & 0x20) // TX_DS, request is acknowledged
+		{
+			nrf24l01_clear_tx_ds();
+			nrf24l01_switch_role(PRX);
+			station->state = SLOT_SETTLING_RX;
+			slot_timer_start(station, NRF24L01_SETTLING_US);
+		}
+		else if (status & 0x10) // MAX_RT
+		{
+			nrf24l01_clear_max_rt();
+			nrf24l01_flush_tx_fifo();
+			station->lost++;
+			slot_end(station, NULL);
+		}
+	}
+	else if ((station->state == SLOT_SETTLING_RX || station->state == SLOT_RX_WAIT) && (status & 0x40))
+	{
+		nrf24l01_read_rx_fifo(station->response);
+		nrf24l01_clear_rx_dr();
+		station->responses++;
+		slot_end(station, station->response);
+	}
+	else
+	{
+		nrf24l01_write_reg(STATUS, status & 0x70); // stale flags
+	}
+}
+
+void nrf24l01_station_timer(nrf24l01_station *station)
+{
+	// a command is in progress (main loop or IRQ handler): come back with the state unchanged
+	if (nrf24l01_bus_busy())
+	{
+		slot_timer_start(station, NRF24L01_BUS_RETRY_US);
+		return;
+	}
+
+	nrf24l01_bus_lock();
+	if (station->irq_pending)
+	{
+		// the retry took the place of the slot timer, arm it again if the IRQ did not move on
+		nrf24l01_slot_state state = station->state;
+		station->irq_pending = false;
+		station_irq(station);
+		if (station->state == state && state != SLOT_IDLE)
+		{
+			bool settling = (state == SLOT_SETTLING_TX || state == SLOT_SETTLING_RX);
+			slot_timer_start(station, settling ? NRF24L01_SETTLING_US : station->window_us);
+		}
+	}
+	else
+	{
+		station_timer(station);
+	}
+	nrf24l01_bus_unlock();
+}
+
+void nrf24l01_station_irq(nrf24l01_station *station)
+{
+	if (nrf24l01_bus_busy())
+	{
+		station->irq_pending = true;
+		slot_timer_start(station, NRF24L01_BUS_RETRY_US);
+		return;
+	}
+
+	nrf24l01_bus_lock();
+	station_irq(station);
+	nrf24l01_bus_unlock();
+}
+
+__weak void nrf24l01_station_callback(uint8_t node, uint8_t *response)
+{
+	UNUSED(node);
+	UNUSED(response);
+}
+
+void nrf24l01_node_init(nrf24l01_node *node, platform_timer *htim, const uint8_t *address)
+{
+	uint8_t rf_setup = nrf24l01_read_reg(RF_SETUP);
+	// ACK packet: 1 byte preamble, 5 bytes address, 9 bits PCF, 2 bytes CRC = 73 bits, after Tstby2a
+	uint16_t bit_ns = (rf_setup & (1 << 5)) ? 4000 : (rf_setup & (1 << 3)) ? 500 : 1000;
+
+	memset(node->response, 0, sizeof(node->response));
+	node->htim = htim;
+	node->ack_wait = false;
+	node->answering = false;
+	node->pending = false;
+	node->ack_us = NRF24L01_SETTLING_US + 73 * bit_ns / 1000;
+	nrf24l01_set_tx_address(address);
+	nrf24l01_switch_role(PRX);
+}
+
+uint8_t nrf24l01_node_irq(nrf24l01_node *node, uint8_t *request)
+{
+	uint32_t irq_time = platform_micros();
+	uint8_t received = 0;
+
+	if (nrf24l01_bus_busy())
+	{
+		node->pending = true;
+		return 0;
+	}
+
+	nrf24l01_bus_lock();
+	node->pending = false;
+	uint8_t status = nrf24l01_get_status();
+
+	if (!node->answering && !node->ack_wait && (status & 0x40)) // RX_DR
+	{
+		nrf24l01_read_rx_fifo(request);
+		nrf24l01_clear_rx_dr();
+		// PRX is still sending the auto ACK of the request, leaving RX now would cut it:
+		// nrf24l01_node_timer switches to PTX once the rest of ack_us is over
+		uint32_t elapsed = platform_micros() - irq_time;
+		node->ack_wait = true;
+		one_shot_start(node->htim, (elapsed + 1 < node->ack_us) ? node->ack_us - elapsed : 1);
+		received = 1;
+	}
+	else if (node->answering && (status & 0x30)) // TX_DS or MAX_RT
+	{
+		if (status & 0x10) nrf24l01_flush_tx_fifo();
+		nrf24l01_write_reg(STATUS, status & 0x30);
+		nrf24l01_switch_role(PRX);
+		node->answering = false;
+	}
+
+	nrf24l01_bus_unlock();
+	return received;
+}
+
+void nrf24l01_node_timer(nrf24l01_node *node)
+{
+	// a command is in progress (main loop or IRQ handler): come back, the ACK is long gone by then
+	if (nrf24l01_bus_busy())
+	{
+		one_shot_start(node->htim, NRF24L01_BUS_RETRY_US);
+		return;
+	}
+
+	nrf24l01_bus_lock();
+	platform_timer_stop_it(node->htim);
+	if (node->ack_wait)
+	{
+		// settling runs while the payload is already waiting in TX FIFO
+		nrf24l01_switch_role(PTX);
+		nrf24l01_write_tx_fifo(node->response);
+		node->ack_wait = false;
+		node->answering = true;
+	}
+	nrf24l01_bus_unlock();
+}
@@ -0,0 +1,142 @@
+/*
+ * nrf24l01_slot.h
+ *
+ *  Time-slotted request/response over one half-duplex nRF24L01+ link
+ *  Station polls nodes round-robin: request (PTX) -> switch role -> response (PRX)
+ *  Node waits in PRX and answers each request from its PTX.
+ *
+ *  Addresses: station uses node address as TX_ADDR and RX_ADDR_P0,
+ *             node uses its own address as TX_ADDR and RX_ADDR_P0.
+ *
+ *  SPI from interrupts: each handler holds the SPI bus (nrf24l01_bus_lock) for its whole
+ *  run, and finds it busy when it preempts the main loop or the other handler mid-command.
+ *  Then it defers: station work is retried from the station timer after NRF24L01_BUS_RETRY_US,
+ *  the node ACK window timer retries the same way, a node request waits for
+ *  nrf24l01_node_irq from main loop (node->pending).
+ *  Give the IRQ pin EXTI and the station / node timer the same preemption priority, so a deferred
+ *  IRQ is not held back until the timer handler ends.
+ */
+
+#ifndef SRC_NRF24L01_SLOT_H_
+#define SRC_NRF24L01_SLOT_H_
+
+#include "nRF24L01.h"
+
+/* User Configurations */
+#define NRF24L01_MAX_NODE               8
+#define NRF24L01_BUS_RETRY_US           20    // station retry when the SPI bus is busy
+/* End User Configurations */
+
+typedef enum
+{
+	SLOT_IDLE = 0,
+	SLOT_SETTLING_TX,	// wait for PTX settling before request
+	SLOT_TX_WAIT,		// wait for TX_DS / MAX_RT of request
+	SLOT_SETTLING_RX,	// wait for PRX settling before listening
+	SLOT_RX_WAIT		// response window
+} nrf24l01_slot_state;
+
+typedef struct
+{
+	platform_timer *htim;			// 1us tick timer used for settling and slot timeout
+	uint8_t address[NRF24L01_MAX_NODE][5];
+	uint8_t nums_of_node;
+	volatile uint8_t node;				// polled node
+	uint16_t window_us;					// time to wait for response
+	uint8_t request[NRF24L01_PAYLOAD_LENGTH];
+	uint8_t response[NRF24L01_PAYLOAD_LENGTH];
+	volatile nrf24l01_slot_state state;
+	volatile bool irq_pending;			// IRQ pin came while the SPI bus was busy
+	uint32_t responses;
+	uint32_t timeouts;
+	uint32_t lost;						// request not acknowledged
+} nrf24l01_station;
+
+typedef struct
+{
+	platform_timer *htim;			// 1us tick timer used for the ACK window
+	uint8_t response[NRF24L01_PAYLOAD_LENGTH];
+	volatile bool ack_wait;				// request read, its auto ACK is still on air
+	volatile bool answering;			// PTX until response is finished
+	volatile bool pending;				// IRQ pin came while the SPI bus was busy
+	uint16_t ack_us;					// from RX_DR until the auto ACK is on air
+} nrf24l01_node;
+
+/* Station */
+/**
+  * @brief  Init station (call after nrf24l01_tx_init)
+  * @param  *station is pointer to the station structure
+  * @param  *htim is timer counting 1us per tick, its update interrupt drives the slots
+  * @param  window_us is response window of a node (us)
+*/
+void nrf24l01_station_init(nrf24l01_station *station, platform_timer *htim, uint16_t window_us);
+
+/**
+  * @brief  Add node to polling list
+  * @param  *station is pointer to the station structure
+  * @param  *address is 5 bytes address of node
+  * @return index of node, 0xFF if list is full
+*/
+uint8_t nrf24l01_station_add_node(nrf24l01_station *station, const uint8_t *address);
+
+/**
+  * @brief  Start polling from first node (station->request is sent to every node)
+  * @param  *station is pointer to the station structure
+*/
+void nrf24l01_station_start(nrf24l01_station *station);
+
+/**
+  * @brief  Stop polling after current slot
+  * @param  *station is pointer to the station structure
+*/
+void nrf24l01_station_stop(nrf24l01_station *station);
+
+/**
+  * @brief  throw into HAL_GPIO_EXTI_Callback when pin is NRF24L01_IRQ_PIN_NUMBER
+  * @param  *station is pointer to the station structure
+*/
+void nrf24l01_station_irq(nrf24l01_station *station);
+
+/**
+  * @brief  throw into HAL_TIM_PeriodElapsedCallback when htim is station timer
+  * @param  *station is pointer to the station structure
+*/
+void nrf24l01_station_timer(nrf24l01_station *station);
+
+/**
+  * @brief  Called when a slot is finished (weak, override it in user code)
+  * @param  node is index of node
+  * @param  *response is received payload, NULL if node did not answer
+*/
+void nrf24l01_station_callback(uint8_t node, uint8_t *response);
+
+/* Node */
+/**
+  * @brief  Init node (call after nrf24l01_rx_init, the ACK time follows its air data rate)
+  * @param  *node is pointer to the node structure
+  * @param  *htim is timer counting 1us per tick, its update interrupt ends the ACK window
+  * @param  *address is own 5 bytes address
+*/
+void nrf24l01_node_init(nrf24l01_node *node, platform_timer *htim, const uint8_t *address);
+
+/**
+  * @brief  throw into HAL_GPIO_EXTI_Callback when pin is NRF24L01_IRQ_PIN_NUMBER
+  *         answers every request with node->response
+  *         the request is read at once, the switch to PTX is left to nrf24l01_node_timer
+  *         node->ack_us after RX_DR (about 420us at 250kbps, 170us at 2Mbps) so the auto ACK
+  *         of the request is not cut off
+  *         also call it from main loop when node->pending is set (SPI bus was busy)
+  * @param  *node is pointer to the node structure
+  * @param  *request receives the request payload
+  * @return 1 if a request is received
+*/
+uint8_t nrf24l01_node_irq(nrf24l01_node *node, uint8_t *request);
+
+/**
+  * @brief  End of the ACK window: switch to PTX and load node->response
+  *         throw into HAL_TIM_PeriodElapsedCallback when htim is node timer
+  * @param  *node is pointer to the node structure
+*/
+void nrf24l01_node_timer(nrf24l01_node *node);
+
+#endif /* SRC_NRF24L01_SLOT_H_ */
@@ -0,0 +1,115 @@
+/*
+ * nrf24l01_bench.c
+ *
+ *  Throughput benchmark of nRF24L01.c on the host chip model
+ *  Reports packets/s, goodput and latency percentiles (simulated time), and the
+ *  mean latency of nrf24l01_link_stats as a check of the driver side measurement
+ *  for several retry settings, air data rates and loss rates.
+ *
+ *  Build and run (repeat with other payload widths, 1 - 32 bytes):
+ *    gcc -O2 -D PLATFORM_SIM -I Platform/sim -D NRF24L01_PAYLOAD_LENGTH=32 \
+ *        Platform/sim/platform_sim.c nRF24L01/nRF24L01.c nRF24L01/sim/nrf24l01_sim.c \
+ *        nRF24L01/sim/nrf24l01_bench.c -o nrf24l01_bench
+ *    ./nrf24l01_bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "nrf24l01_sim.h"
+#include "../nRF24L01.h"
+
+#define BENCH_PACKETS 2000
+
+typedef struct
+{
+	air_data_rate bps;
+	count arc;
+	delay ard;
+	uint8_t loss_percent;
+} bench_case;
+
+static uint64_t bench_time_us(void)	{	return platform_sim_time_ns() / 1000;	}
+
+static int compare_u32(const void *a, const void *b)
+{
+	uint32_t x = *(const uint32_t *)a;
+	uint32_t y = *(const uint32_t *)b;
+	return (x > y) - (x < y);
+}
+
+static const char *rate_name(air_data_rate bps)
+{
+	switch (bps)
+	{
+	case _250kbps:	return "250k";
+	case _2Mbps:	return "2M";
+	default:		return "1M";
+	}
+}
+
+static void bench_run(const bench_case *bench)
+{
+	static uint32_t latency[BENCH_PACKETS];
+	uint8_t payload[NRF24L01_PAYLOAD_LENGTH];
+	nrf24l01_sim_config config = {bench->loss_percent, 12345, 10500000, 2000};
+	nrf24l01_link_stats stats;
+
+	platform_sim_init();
+	nrf24l01_sim_init(&config);
+	nrf24l01_tx_init(2450, bench->bps);
+	nrf24l01_auto_retransmit_count(bench->arc);
+	nrf24l01_auto_retransmit_delay(bench->ard);
+	nrf24l01_reset_link_stats();
+
+	uint32_t spi_start = nrf24l01_sim_spi_transactions();
+	uint64_t start = bench_time_us();
+
+	for (uint32_t i = 0; i < BENCH_PACKETS; i++)
+	{
+		for (uint8_t j = 0; j < NRF24L01_PAYLOAD_LENGTH; j++) payload[j] = i + j;
+
+		uint64_t t0 = bench_time_us();
+		nrf24l01_tx_transmit(payload);
+		nrf24l01_sim_wait_irq(100000);
+		nrf24l01_tx_irq();
+		latency[i] = bench_time_us() - t0;
+	}
+
+	double seconds = (bench_time_us() - start) / 1e6;
+	nrf24l01_get_link_stats(&stats);
+	qsort(latency, BENCH_PACKETS, sizeof(latency[0]), compare_u32);
+
+	printf("%-5s %3u %5u %5u%% | %9.0f %10.1f | %6u %6u %6u %7.0f | %5.1f%% %5.2f\n",
+		   rate_name(bench->bps), bench->arc, bench->ard, bench->loss_percent,
+		   BENCH_PACKETS / seconds,
+		   stats.acked * NRF24L01_PAYLOAD_LENGTH * 8 / seconds / 1000,
+		   latency[BENCH_PACKETS / 2], latency[BENCH_PACKETS * 9 / 10], latency[BENCH_PACKETS * 99 / 100],
+		   (double)stats.latency_sum / (stats.acked + stats.lost),
+		   100.0 * stats.lost / BENCH_PACKETS,
+		   (double)(nrf24l01_sim_spi_transactions() - spi_start) / BENCH_PACKETS);
+}
+
+int main(void)
+{
+	static const bench_case cases[] =
+	{
+		{_2Mbps,   3,  250,  0},
+		{_2Mbps,   3,  250,  5},
+		{_2Mbps,   3,  250, 20},
+		{_2Mbps,  15,  250, 20},
+		{_2Mbps,  15, 1000, 20},
+		{_1Mbps,   3,  250,  0},
+		{_1Mbps,   3,  250, 20},
+		{_1Mbps,  15,  500, 20},
+		{_250kbps, 3,  500,  0},
+		{_250kbps, 15, 500, 20},
+	};
+
+	printf("payload %u bytes, %u packets per case (simulated time)\n", NRF24L01_PAYLOAD_LENGTH, BENCH_PACKETS);
+	printf("rate  ARC   ARD  loss | packets/s goodput kb | p50 us p90 us p99 us mean us | lost   CS/pkt\n");
+	for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+	{
+		bench_run(&cases[i]);
+	}
+	return 0;
+}
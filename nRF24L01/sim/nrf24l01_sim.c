@@ -0,0 +1,358 @@
+/*
+ * nrf24l01_sim.c
+ *
+ *  Host model of one nRF24L01+ behind the platform sim SPI/GPIO
+ */
+
+#include "nrf24l01_sim.h"
+#include "../nRF24L01.h"
+
+#define SIM_FIFO_DEPTH		3
+#define SIM_CHANNELS		126
+
+platform_spi hspi1;
+
+typedef struct
+{
+	uint8_t data[NRF24L01_MAX_TRANSFER];
+	uint8_t length;
+} sim_payload;
+
+static struct
+{
+	nrf24l01_sim_config config;
+	uint8_t reg[0x20][5];
+	sim_payload tx_fifo[SIM_FIFO_DEPTH];
+	uint8_t tx_count;
+	sim_payload rx_fifo[SIM_FIFO_DEPTH];
+	uint8_t rx_count;
+	uint8_t noise[SIM_CHANNELS];
+
+	bool cs_low;
+	bool ce;
+	uint8_t cmd;
+	uint8_t index;		// data byte of current command
+
+	bool tx_busy;		// payload on air
+	uint64_t tx_done_ns;
+	bool tx_acked;
+	uint8_t tx_arc;
+
+	uint32_t random;
+	uint32_t delivered;
+	uint32_t transactions;
+} sim;
+
+static uint64_t sim_now(void)	{	return platform_sim_time_ns();	}
+
+static uint32_t sim_random(void)
+{
+	uint32_t x = sim.random;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	sim.random = x;
+	return x;
+}
+
+static uint8_t reg_width(uint8_t address)
+{
+	switch (address)
+	{
+	case RX_ADDR_P0:
+	case RX_ADDR_P1:
+	case TX_ADDR:
+		return 5;
+	default:
+		return 1;
+	}
+}
+
+static uint8_t sim_status(void)
+{
+	uint8_t rx_p_no = sim.rx_count ? 0 : 7;
+	return (sim.reg[STATUS][0] & 0x70) | (rx_p_no << 1) | (sim.tx_count == SIM_FIFO_DEPTH);
+}
+
+static uint8_t sim_fifo_status(void)
+{
+	return ((sim.tx_count == SIM_FIFO_DEPTH) << 5) | ((sim.tx_count == 0) << 4)
+		 | ((sim.rx_count == SIM_FIFO_DEPTH) << 1) | (sim.rx_count == 0);
+}
+
+// air time of a packet in ns: preamble + address + PCF + payload + CRC
+static uint64_t air_ns(uint8_t payload_bytes)
+{
+	uint8_t rf_setup = sim.reg[RF_SETUP][0];
+	uint32_t kbps = (rf_setup & (1 << 5)) ? 250 : ((rf_setup & (1 << 3)) ? 2000 : 1000);
+	uint8_t aw = sim.reg[SETUP_AW][0] + 2;
+	uint8_t crc = (sim.reg[CONFIG][0] & 0x08) ? ((sim.reg[CONFIG][0] & 0x04) ? 2 : 1) : 0;
+	uint32_t bits = 8 * (1 + aw + payload_bytes + crc) + 9;
+
+	return (uint64_t)bits * 1000000 / kbps;
+}
+
+// start next payload when chip is PTX, powered, CE high and MAX_RT is cleared
+static void sim_try_transmit(uint64_t start_ns)
+{
+	uint8_t config = sim.reg[CONFIG][0];
+
+	if (sim.tx_busy || !sim.ce || sim.tx_count == 0) return;
+	if (!(config & 0x02) || (config & 0x01)) return;
+	if (sim.reg[STATUS][0] & 0x10) return;
+
+	uint8_t arc = sim.reg[SETUP_RETR][0] & 0x0F;
+	uint64_t ard_ns = (uint64_t)(((sim.reg[SETUP_RETR][0] >> 4) + 1) * 250) * 1000;
+	uint64_t t = start_ns + NRF24L01_SETTLING_US * 1000;
+
+	sim.tx_acked = false;
+	for (sim.tx_arc = 0; ; sim.tx_arc++)
+	{
+		t += air_ns(sim.tx_fifo[0].length);
+		if (sim_random() % 100 >= sim.config.loss_percent)
+		{
+			sim.delivered++;
+			// ACK: turnaround + empty packet
+			t += NRF24L01_SETTLING_US * 1000 + air_ns(0);
+			if (sim_random() % 100 >= sim.config.loss_percent)
+			{
+				sim.tx_acked = true;
+				break;
+			}
+		}
+		if (sim.tx_arc >= arc) break;
+		t += ard_ns;
+	}
+
+	sim.tx_busy = true;
+	sim.tx_done_ns = t;
+}
+
+static void sim_update(void)
+{
+	while (sim.tx_busy && sim_now() >= sim.tx_done_ns)
+	{
+		uint8_t plos = sim.reg[OBSERVE_TX][0] >> 4;
+
+		sim.tx_busy = false;
+		if (sim.tx_acked)
+		{
+			sim.reg[STATUS][0] |= 0x20;
+			sim.tx_count--;
+			for (uint8_t i = 0; i < sim.tx_count; i++) sim.tx_fifo[i] = sim.tx_fifo[i + 1];
+		}
+		else
+		{
+			sim.reg[STATUS][0] |= 0x10;
+			if (plos < 15) plos++;
+		}
+		sim.reg[OBSERVE_TX][0] = (plos << 4) | sim.tx_arc;
+
+		sim_try_transmit(sim.tx_done_ns);
+	}
+}
+
+static void sim_spend_ns(uint64_t ns)	{	platform_sim_advance_ns(ns);	}
+
+// active low, CONFIG bit 6:4 mask RX_DR, TX_DS, MAX_RT
+static bool sim_irq_level(void)
+{
+	sim_update();
+	return !(sim.reg[STATUS][0] & ~sim.reg[CONFIG][0] & 0x70);
+}
+
+static void sim_cs_rising(void)
+{
+	if (sim.cmd == W_TX_PAYLOAD && sim.index && sim.tx_count < SIM_FIFO_DEPTH)
+	{
+		sim.tx_fifo[sim.tx_count].length = sim.index;
+		sim.tx_count++;
+		sim_try_transmit(sim_now());
+	}
+	else if (sim.cmd == R_RX_PAYLOAD && sim.index && sim.rx_count)
+	{
+		sim.rx_count--;
+		for (uint8_t i = 0; i < sim.rx_count; i++) sim.rx_fifo[i] = sim.rx_fifo[i + 1];
+	}
+	else if ((sim.cmd & 0xE0) == W_REGISTER && sim.index)
+	{
+		uint8_t address = sim.cmd & REGISTER_MASK;
+		if (address == RF_CH) sim.reg[OBSERVE_TX][0] &= 0x0F; // PLOS_CNT reset
+		if (address == STATUS) sim_try_transmit(sim_now());  // MAX_RT cleared
+	}
+}
+
+static uint8_t sim_spi_byte(uint8_t mosi)
+{
+	uint8_t miso = 0xFF;
+
+	if (!sim.cs_low) return miso;
+
+	if (sim.index == 0xFF) // first byte of the transaction
+	{
+		sim.cmd = mosi;
+		sim.index = 0;
+		switch (mosi)
+		{
+		case FLUSH_TX:
+			// payload on air is dropped with the FIFO, its TX_DS / MAX_RT never comes
+			sim.tx_count = 0;
+			sim.tx_busy = false;
+			break;
+		case FLUSH_RX:
+			sim.rx_count = 0;
+			break;
+		}
+		return sim_status();
+	}
+
+	uint8_t cmd = sim.cmd;
+	uint8_t i = sim.index++;
+
+	if ((cmd & 0xE0) == R_REGISTER)
+	{
+		uint8_t address = cmd & REGISTER_MASK;
+		if (address == STATUS)				miso = sim_status();
+		else if (address == FIFO_STATUS)	miso = sim_fifo_status();
+		else if (address == CD)				miso = (sim.rx_count < SIM_FIFO_DEPTH && (sim.reg[CONFIG][0] & 0x01) && sim.ce
+												&& sim_random() % 100 < sim.noise[sim.reg[RF_CH][0] % SIM_CHANNELS]);
+		else if (i < reg_width(address))	miso = sim.reg[address][i];
+	}
+	else if ((cmd & 0xE0) == W_REGISTER)
+	{
+		uint8_t address = cmd & REGISTER_MASK;
+		if (address == STATUS)				sim.reg[STATUS][0] &= ~(mosi & 0x70); // write 1 to clear
+		else if (address == OBSERVE_TX || address == CD || address == FIFO_STATUS) {} // read only
+		else if (i < reg_width(address))	sim.reg[address][i] = mosi;
+	}
+	else if (cmd == R_RX_PAYLOAD)
+	{
+		if (sim.rx_count && i < NRF24L01_MAX_TRANSFER) miso = sim.rx_fifo[0].data[i];
+	}
+	else if (cmd == W_TX_PAYLOAD)
+	{
+		if (sim.tx_count < SIM_FIFO_DEPTH && i < NRF24L01_MAX_TRANSFER) sim.tx_fifo[sim.tx_count].data[i] = mosi;
+	}
+
+	return miso;
+}
+
+static void sim_spi(const uint8_t *tx, uint8_t *rx, uint16_t size)
+{
+	sim_spend_ns((uint64_t)size * 8 * 1000000000ull / sim.config.spi_hz);
+	for (uint16_t i = 0; i < size; i++)
+	{
+		uint8_t miso = sim_spi_byte(tx ? tx[i] : NOP);
+		if (rx) rx[i] = miso;
+	}
+}
+
+/* Platform hooks */
+static void sim_hook(uint64_t now_ns)
+{
+	UNUSED(now_ns);
+	sim_update();
+}
+
+static void sim_spi_transfer(void *context, const uint8_t *tx, uint8_t *rx, uint16_t len)
+{
+	UNUSED(context);
+	sim_spi(tx, rx, len);
+}
+
+static void sim_gpio_write(platform_gpio *port, uint16_t pin, bool level)
+{
+	if (port == NRF24L01_SPI_CS_PIN_PORT && pin == NRF24L01_SPI_CS_PIN_NUMBER)
+	{
+		bool cs_low = !level;
+		if (cs_low && !sim.cs_low)
+		{
+			sim.index = 0xFF;
+			sim.transactions++;
+			sim_spend_ns(sim.config.cs_overhead_ns);
+		}
+		else if (!cs_low && sim.cs_low)
+		{
+			sim_cs_rising();
+		}
+		sim.cs_low = cs_low;
+	}
+	else if (port == NRF24L01_CE_PIN_PORT && pin == NRF24L01_CE_PIN_NUMBER)
+	{
+		sim.ce = level;
+		sim_try_transmit(sim_now());
+	}
+}
+
+static bool sim_gpio_read(platform_gpio *port, uint16_t pin, bool level)
+{
+	if (port == NRF24L01_IRQ_PIN_PORT && pin == NRF24L01_IRQ_PIN_NUMBER) return sim_irq_level();
+	return level;
+}
+
+void nrf24l01_sim_init(const nrf24l01_sim_config *config)
+{
+	memset(&sim, 0, sizeof(sim));
+	sim.config = *config;
+	if (sim.config.spi_hz == 0) sim.config.spi_hz = 10500000;
+	sim.random = config->seed ? config->seed : 1;
+	sim.index = 0xFF;
+
+	// power on reset values
+	sim.reg[CONFIG][0] = 0x08;
+	sim.reg[EN_AA][0] = 0x3F;
+	sim.reg[EN_RXADDR][0] = 0x03;
+	sim.reg[SETUP_AW][0] = 0x03;
+	sim.reg[SETUP_RETR][0] = 0x03;
+	sim.reg[RF_CH][0] = 0x02;
+	sim.reg[RF_SETUP][0] = 0x0F;
+	memset(sim.reg[RX_ADDR_P0], 0xE7, 5);
+	memset(sim.reg[RX_ADDR_P1], 0xC2, 5);
+	memset(sim.reg[TX_ADDR], 0xE7, 5);
+	sim.reg[RX_ADDR_P2][0] = 0xC3;
+	sim.reg[RX_ADDR_P3][0] = 0xC4;
+	sim.reg[RX_ADDR_P4][0] = 0xC5;
+	sim.reg[RX_ADDR_P5][0] = 0xC6;
+
+	hspi1.transfer = sim_spi_transfer;
+	NRF24L01_SPI_CS_PIN_PORT->on_write = sim_gpio_write;
+	NRF24L01_CE_PIN_PORT->on_write = sim_gpio_write;
+	NRF24L01_IRQ_PIN_PORT->on_read = sim_gpio_read;
+	platform_sim_add_hook(sim_hook);
+}
+
+bool nrf24l01_sim_wait_irq(uint32_t timeout_us)
+{
+	uint64_t deadline = sim_now() + (uint64_t)timeout_us * 1000;
+
+	while (sim_irq_level())
+	{
+		if (!sim.tx_busy || sim.tx_done_ns > deadline)
+		{
+			sim_spend_ns(deadline - sim_now());
+			return !sim_irq_level();
+		}
+		sim_spend_ns(sim.tx_done_ns - sim_now());
+	}
+	return true;
+}
+
+bool nrf24l01_sim_inject_rx(const uint8_t *payload)
+{
+	uint8_t config = sim.reg[CONFIG][0];
+
+	if (!sim.ce || !(config & 0x02) || !(config & 0x01)) return false;
+	if (sim.rx_count == SIM_FIFO_DEPTH) return false;
+
+	sim.rx_fifo[sim.rx_count].length = sim.reg[RX_PW_P0][0];
+	memcpy(sim.rx_fifo[sim.rx_count].data, payload, sim.reg[RX_PW_P0][0]);
+	sim.rx_count++;
+	sim.reg[STATUS][0] |= 0x40;
+	return true;
+}
+
+void nrf24l01_sim_set_noise(uint8_t rf_ch, uint8_t percent)	{	sim.noise[rf_ch % SIM_CHANNELS] = percent;	}
+
+uint32_t nrf24l01_sim_delivered(void)	{	return sim.delivered;	}
+
+uint32_t nrf24l01_sim_spi_transactions(void)	{	return sim.transactions;	}
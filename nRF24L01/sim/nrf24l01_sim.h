@@ -0,0 +1,62 @@
+/*
+ * nrf24l01_sim.h
+ *
+ *  Host model of one nRF24L01+ (register file, 3 deep TX/RX FIFO, auto ACK,
+ *  retransmit timing, packet loss) behind the platform sim SPI/GPIO,
+ *  so nRF24L01.c runs unchanged on Linux. Time is the platform sim time.
+ *  The other end of the link is an ideal PRX which acknowledges every payload it gets.
+ */
+
+#ifndef SIM_NRF24L01_SIM_H_
+#define SIM_NRF24L01_SIM_H_
+
+#include "../../Platform/sim/platform_sim.h"
+#include <stdbool.h>
+
+typedef struct
+{
+	uint8_t loss_percent;		// chance to lose a payload or an ACK on air
+	uint32_t seed;				// packet loss random seed
+	uint32_t spi_hz;			// SPI clock, sets cost of every SPI byte
+	uint16_t cs_overhead_ns;	// HAL call + CS toggle cost per transaction
+} nrf24l01_sim_config;
+
+/**
+  * @brief  Reset chip model and connect it to hspi1 and the CS, CE, IRQ pins
+  *         (call platform_sim_init first)
+  * @param  *config is link configuration
+*/
+void nrf24l01_sim_init(const nrf24l01_sim_config *config);
+
+/**
+  * @brief  Advance time until IRQ pin goes low
+  * @param  timeout_us is maximum time to wait
+  * @return true if IRQ is asserted
+*/
+bool nrf24l01_sim_wait_irq(uint32_t timeout_us);
+
+/**
+  * @brief  Payload sent by the other end (lands in RX FIFO when chip is PRX)
+  * @param  *payload is received data (NRF24L01 payload width of pipe 0)
+  * @return false if chip is not listening or RX FIFO is full
+*/
+bool nrf24l01_sim_inject_rx(const uint8_t *payload);
+
+/**
+  * @brief  Set noise of a channel, RPD is high with this chance while listening on it
+  * @param  rf_ch is channel (0 - 125)
+  * @param  percent is chance of carrier detect
+*/
+void nrf24l01_sim_set_noise(uint8_t rf_ch, uint8_t percent);
+
+/**
+  * @brief  Payloads received by the other end (duplicates of lost ACK included)
+*/
+uint32_t nrf24l01_sim_delivered(void);
+
+/**
+  * @brief  SPI transactions (CS cycles) since init
+*/
+uint32_t nrf24l01_sim_spi_transactions(void);
+
+#endif /* SIM_NRF24L01_SIM_H_ */